@@ -1,129 +1,108 @@
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define MAX_ITEMS 100
-#define MAX_TRANSACTIONS 100
-
-// A structure to hold transaction data
-typedef struct {
-    int items[MAX_ITEMS];
-    int num_items;
-} Transaction;
-
-// A structure to hold a hashtable entry
-typedef struct {
-    int itemset[MAX_ITEMS];
-    int count;
-} HashEntry;
-
-// Hash Table parameters
-#define HASH_SIZE 101
-HashEntry hashTable[HASH_SIZE];
-
-// Helper function to hash itemsets
-int hash(int *itemset, int length) {
-    int hashValue = 0;
-    for (int i = 0; i < length; i++) {
-        hashValue = (hashValue * 31 + itemset[i]) % HASH_SIZE;
+#include "dm.h"
+
+// Driver for the dm library: mines a transaction file (or the built-in sample)
+// with hash counting, Partition, DIC and the Count-Min approximate mode.
+//
+// Build: cc -O2 1.c dm.c -lm -o 1
+// Usage: 1 [transactions file] [min_support] [itemset_size] [--cust]
+//   --cust reads the "custID transID n items..." layout of the LAB4 datasets
+
+static void printItemsets(const char *title, const dm_itemsets *itemsets) {
+    printf("%s\n", title);
+    for (size_t i = 0; i < itemsets->count; i++) {
+        printf("{ ");
+        for (size_t j = itemsets->offsets[i]; j < itemsets->offsets[i + 1]; j++) {
+            printf("%d ", itemsets->items[j]);
+        }
+        printf("} occurs %u times\n", itemsets->support[i]);
     }
-    return hashValue;
 }
 
-// Hash-Based Algorithm to count itemsets
-void hashBasedAlgorithm(Transaction transactions[], int num_transactions, int itemset_size) {
-    // Initialize hash table
-    for (int i = 0; i < HASH_SIZE; i++) {
-        hashTable[i].count = 0;
-    }
-    
-    // Count itemsets
-    for (int i = 0; i < num_transactions; i++) {
-        for (int j = 0; j < transactions[i].num_items - itemset_size + 1; j++) {
-            int itemset[itemset_size];
-            for (int k = 0; k < itemset_size; k++) {
-                itemset[k] = transactions[i].items[j + k];
-            }
-            int index = hash(itemset, itemset_size);
-            hashTable[index].count++;
-        }
-    }
-    
-    // Print frequent itemsets
-    printf("Hash-Based Algorithm Results:\n");
-    for (int i = 0; i < HASH_SIZE; i++) {
-        if (hashTable[i].count > 1) {
-            printf("Itemset hash %d occurs %d times\n", i, hashTable[i].count);
-        }
+static int check(dm_status status, const char *what) {
+    if (status != DM_OK) {
+        fprintf(stderr, "%s failed with status %d\n", what, status);
+        return 0;
     }
+    return 1;
 }
 
-// Partition-Based Algorithm
-void partitionBasedAlgorithm(Transaction transactions[], int num_transactions, int itemset_size) {
-    printf("Partition-Based Algorithm Results:\n");
-    int partitionSize = num_transactions / 2;
-
-    for (int part = 0; part < 2; part++) {
-        int start = part * partitionSize;
-        int end = (part + 1) * partitionSize;
-
-        int local_counts[MAX_ITEMS] = {0};
-
-        // Count itemsets in the partition
-        for (int i = start; i < end; i++) {
-            for (int j = 0; j < transactions[i].num_items; j++) {
-                local_counts[transactions[i].items[j]]++;
-            }
+// Sample data and main function to execute the algorithms
+int main(int argc, char *argv[]) {
+    dm_txdb db;
+    double min_support = argc > 2 ? atof(argv[2]) : 0.5;
+    size_t itemset_size = argc > 3 ? (size_t)atoi(argv[3]) : 2;
+    dm_format format = DM_FORMAT_ITEMS;
+    if (argc > 4) {
+        if (argc > 5 || strcmp(argv[4], "--cust") != 0) {
+            fprintf(stderr, "Usage: %s [transactions file] [min_support] [itemset_size] [--cust]\n", argv[0]);
+            return 1;
         }
+        format = DM_FORMAT_CUST_TRANS;
+    }
 
-        // Print itemsets for the partition
-        printf("Partition %d:\n", part + 1);
-        for (int i = 0; i < MAX_ITEMS; i++) {
-            if (local_counts[i] > 1) {
-                printf("Item %d occurs %d times\n", i, local_counts[i]);
-            }
+    if (argc > 1) {
+        if (!check(dm_txdb_load(&db, argv[1], format, NULL), "Loading transactions")) return 1;
+    } else {
+        static const int32_t sample[4][3] = {
+            {1, 2, 3},
+            {2, 3, 4},
+            {1, 2, 4},
+            {1, 3, 4},
+        };
+        if (!check(dm_txdb_init(&db, NULL), "Creating database")) return 1;
+        for (int i = 0; i < 4; i++) {
+            if (!check(dm_txdb_add(&db, sample[i], 3), "Adding transaction")) return 1;
         }
     }
-}
 
-// DIC Algorithm (Dynamic Itemset Counting)
-void dicAlgorithm(Transaction transactions[], int num_transactions, int min_support) {
-    printf("DIC Algorithm Results:\n");
-    int counts[MAX_ITEMS] = {0};
-
-    // Scan dataset multiple times dynamically counting itemsets
-    for (int pass = 0; pass < 3; pass++) {
-        printf("Pass %d:\n", pass + 1);
-        for (int i = 0; i < num_transactions; i++) {
-            for (int j = 0; j < transactions[i].num_items; j++) {
-                counts[transactions[i].items[j]]++;
-            }
+    // One threshold for every miner: support of at least min_support of all transactions
+    double count = ceil(min_support * (double)db.num_transactions - 1e-9);
+    uint32_t min_count = count < 1 ? 1 : (uint32_t)count;
+    printf("Transactions: %zu, Min Support Count: %u\n", db.num_transactions, min_count);
+
+    // Zeroed so freeing is safe whichever allocation failed
+    dm_itemsets hashed = {0}, partitioned = {0}, dic = {0}, sketched = {0};
+    int ok = check(dm_itemsets_init(&hashed, NULL), "Allocating results") &&
+             check(dm_itemsets_init(&partitioned, NULL), "Allocating results") &&
+             check(dm_itemsets_init(&dic, NULL), "Allocating results") &&
+             check(dm_itemsets_init(&sketched, NULL), "Allocating results");
+
+    // A failed miner does not stop the others, but fails the run
+    if (ok) {
+        if (check(dm_hash_count(&db, itemset_size, min_count, &hashed), "Hash counting")) {
+            printItemsets("Hash-Based Algorithm Results:", &hashed);
+        } else {
+            ok = 0;
         }
-
-        // Print counts after each pass
-        for (int i = 0; i < MAX_ITEMS; i++) {
-            if (counts[i] >= min_support) {
-                printf("Item %d has count %d\n", i, counts[i]);
-            }
+        if (check(dm_partition_mine(&db, 2, min_count, &partitioned), "Partition mining")) {
+            printItemsets("Partition-Based Algorithm Results:", &partitioned);
+        } else {
+            ok = 0;
+        }
+        if (check(dm_dic_mine(&db, db.num_transactions / 4 + 1, min_count, &dic), "DIC mining")) {
+            printItemsets("DIC Algorithm Results:", &dic);
+        } else {
+            ok = 0;
+        }
+        dm_cms_stats stats;
+        if (check(dm_cms_mine(&db, itemset_size, min_count, 1 << 20, &sketched, &stats), "Sketch mining")) {
+            printItemsets("Count-Min Approximate Results:", &sketched);
+            printf("Sketch %zu x %zu, %zu candidates verified, %zu false positives\n", stats.depth, stats.width,
+                   stats.candidates, stats.false_positives);
+        } else {
+            ok = 0;
         }
     }
-}
-
-// Sample data and main function to execute the algorithms
-int main() {
-    Transaction transactions[MAX_TRANSACTIONS] = {
-        {{1, 2, 3}, 3},
-        {{2, 3, 4}, 3},
-        {{1, 2, 4}, 3},
-        {{1, 3, 4}, 3},
-    };
-    int num_transactions = 4;
-    int itemset_size = 2;
-    int min_support = 2;
-
-    hashBasedAlgorithm(transactions, num_transactions, itemset_size);
-    partitionBasedAlgorithm(transactions, num_transactions, itemset_size);
-    dicAlgorithm(transactions, num_transactions, min_support);
 
-    return 0;
+    dm_itemsets_free(&hashed);
+    dm_itemsets_free(&partitioned);
+    dm_itemsets_free(&dic);
+    dm_itemsets_free(&sketched);
+    dm_txdb_free(&db);
+    return ok ? 0 : 1;
 }
@@ -7,6 +7,12 @@
 #include <algorithm>
 #include <iterator>
 #include <ctime>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -20,6 +26,40 @@ struct Transaction {
     Itemset items;
 };
 
+// Item constraints applied during mining rather than as a post-filter.
+// mustExclude and maxLength are anti-monotone: once violated, every superset
+// violates them too. mustInclude ("contains at least one of") is succinct: the
+// qualifying itemsets can be enumerated directly from the allowed items.
+struct Constraints {
+    Itemset mustInclude;
+    Itemset mustExclude;
+    int maxLength = 0; // 0 means unbounded
+};
+
+bool hasRequiredItem(const Itemset& itemset, const Constraints& constraints) {
+    if (constraints.mustInclude.empty()) {
+        return true;
+    }
+    for (int item : itemset) {
+        if (constraints.mustInclude.count(item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Itemset parseItemList(const string& list) {
+    Itemset items;
+    istringstream iss(list);
+    string token;
+    while (getline(iss, token, ',')) {
+        if (!token.empty()) {
+            items.insert(atoi(token.c_str()));
+        }
+    }
+    return items;
+}
+
 vector<Transaction> parseDataset(const string& filename) {
     vector<Transaction> transactions;
     ifstream file(filename);
@@ -44,12 +84,25 @@ vector<Transaction> parseDataset(const string& filename) {
     return transactions;
 }
 
-ItemsetList generateCandidates(const ItemsetList& prevFrequentItemsets) {
+// With a mustInclude constraint only level 1 holds unconstrained items; pairs are
+// generated only when they contain a required item, and from then on every
+// frequent itemset carries one. Any qualifying k-itemset (k >= 3) is the union of
+// two of its qualifying (k-1)-subsets, so the pairwise join stays complete.
+ItemsetList generateCandidates(const ItemsetList& prevFrequentItemsets, const Constraints& constraints) {
     ItemsetList candidates;
     int size = prevFrequentItemsets.size();
 
+    if (size == 0 || (constraints.maxLength > 0 && (int)prevFrequentItemsets[0].size() >= constraints.maxLength)) {
+        return candidates;
+    }
+    bool filterPairs = !constraints.mustInclude.empty() && prevFrequentItemsets[0].size() == 1;
+
     for (int i = 0; i < size; ++i) {
         for (int j = i + 1; j < size; ++j) {
+            if (filterPairs && !hasRequiredItem(prevFrequentItemsets[i], constraints) &&
+                !hasRequiredItem(prevFrequentItemsets[j], constraints)) {
+                continue;
+            }
             Itemset candidate = prevFrequentItemsets[i];
             candidate.insert(prevFrequentItemsets[j].begin(), prevFrequentItemsets[j].end());
 
@@ -59,10 +112,14 @@ ItemsetList generateCandidates(const ItemsetList& prevFrequentItemsets) {
         }
     }
 
+    // The same k-itemset is reached from several pairs; count it only once.
+    sort(candidates.begin(), candidates.end());
+    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
     return candidates;
 }
 
-void pruneCandidates(ItemsetList& candidates, const ItemsetCountMap& frequentItemsets) {
+void pruneCandidates(ItemsetList& candidates, const ItemsetCountMap& frequentItemsets, const Constraints& constraints) {
     for (auto it = candidates.begin(); it != candidates.end();) {
         bool allSubsetsFrequent = true;
 
@@ -70,6 +127,10 @@ void pruneCandidates(ItemsetList& candidates, const ItemsetCountMap& frequentIte
             Itemset subset = *it;
             subset.erase(item);
 
+            // Subsets without a required item were never counted past level 1.
+            if (subset.size() > 1 && !hasRequiredItem(subset, constraints)) {
+                continue;
+            }
             if (frequentItemsets.find(subset) == frequentItemsets.end()) {
                 allSubsetsFrequent = false;
                 break;
@@ -84,10 +145,20 @@ void pruneCandidates(ItemsetList& candidates, const ItemsetCountMap& frequentIte
     }
 }
 
-ItemsetCountMap countItemsets(const ItemsetList& candidates, const vector<Transaction>& transactions) {
+ItemsetCountMap countItemsets(const ItemsetList& candidates, const vector<Transaction>& transactions, const Constraints& constraints) {
     ItemsetCountMap itemsetCountMap;
+    if (candidates.empty()) {
+        return itemsetCountMap;
+    }
+    size_t candidateSize = candidates[0].size();
+    bool needsRequiredItem = candidateSize > 1 && !constraints.mustInclude.empty();
 
     for (const Transaction& transaction : transactions) {
+        // Transactions that cannot hold any constrained candidate are skipped whole.
+        if (transaction.items.size() < candidateSize ||
+            (needsRequiredItem && !hasRequiredItem(transaction.items, constraints))) {
+            continue;
+        }
         for (const Itemset& candidate : candidates) {
             if (includes(transaction.items.begin(), transaction.items.end(), candidate.begin(), candidate.end())) {
                 itemsetCountMap[candidate]++;
@@ -110,6 +181,35 @@ ItemsetList filterFrequentItemsets(const ItemsetCountMap& itemsetCountMap, int m
     return frequentItemsets;
 }
 
+// Under a mustInclude constraint an antecedent without a required item was
+// never counted while mining. Such antecedents are counted here in one more
+// pass, so the rules that need them are not dropped.
+void countMissingAntecedents(const ItemsetList& frequentItemsets, const vector<Transaction>& transactions,
+                             ItemsetCountMap& itemsetCountMap) {
+    ItemsetCountMap missing;
+    for (const Itemset& itemset : frequentItemsets) {
+        for (int item : itemset) {
+            Itemset antecedent = itemset;
+            antecedent.erase(item);
+            if (!antecedent.empty() && !itemsetCountMap.count(antecedent)) {
+                missing.emplace(antecedent, 0);
+            }
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    for (const Transaction& transaction : transactions) {
+        for (auto& pair : missing) {
+            if (includes(transaction.items.begin(), transaction.items.end(), pair.first.begin(), pair.first.end())) {
+                pair.second++;
+            }
+        }
+    }
+    itemsetCountMap.insert(missing.begin(), missing.end());
+}
+
 void generateRules(const ItemsetList& frequentItemsets, const ItemsetCountMap& itemsetCountMap, int totalTransactions, double minConf) {
     for (const Itemset& itemset : frequentItemsets) {
         for (int item : itemset) {
@@ -153,10 +253,231 @@ vector<Transaction> reduceTransactions(const vector<Transaction>& transactions,
     return reducedTransactions;
 }
 
+// Everything needed to continue mining after the last completed level. On disk
+// it is a base file, written once after level 1, with the options and the
+// reduced transactions, plus one file per completed level holding only the
+// counts of that level's candidates.
+struct Checkpoint {
+    int level;
+    int minSupport;
+    int totalTransactions;
+    Constraints constraints;
+    ItemsetList frequentItemsets;
+    ItemsetCountMap itemsetCountMap;
+    vector<Transaction> transactions;
+};
+
+const char CHECKPOINT_MAGIC[8] = {'A', 'D', 'C', 'K', 'P', 'T', '2', '\0'};
+const char LEVEL_MAGIC[8] = {'A', 'D', 'L', 'E', 'V', 'E', 'L', '\0'};
+
+string levelFile(const string& filename, int level) {
+    return filename + "." + to_string(level);
+}
+
+void writeInt(ofstream& out, int32_t value) {
+    out.write((const char*)&value, sizeof(value));
+}
+
+bool readInt(ifstream& in, int32_t& value) {
+    return (bool)in.read((char*)&value, sizeof(value));
+}
+
+void writeItemset(ofstream& out, const Itemset& itemset) {
+    writeInt(out, itemset.size());
+    for (int item : itemset) {
+        writeInt(out, item);
+    }
+}
+
+bool readItemset(ifstream& in, Itemset& itemset) {
+    int32_t size, item;
+    if (!readInt(in, size) || size < 0) {
+        return false;
+    }
+    itemset.clear();
+    for (int i = 0; i < size; ++i) {
+        if (!readInt(in, item)) {
+            return false;
+        }
+        itemset.insert(itemset.end(), item);
+    }
+    return true;
+}
+
+// Flushes a finished temporary file to disk and renames it into place, so a
+// crash at any point leaves either the old file or the complete new one.
+bool commitFile(const string& tempFile, const string& filename) {
+    // ofstream has no descriptor to sync, so the file is reopened
+    int fd = open(tempFile.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced && rename(tempFile.c_str(), filename.c_str()) == 0;
+}
+
+bool saveCheckpointBase(int minSupport, int totalTransactions, const Constraints& constraints,
+                        const vector<Transaction>& transactions, const string& filename) {
+    string tempFile = filename + ".tmp";
+    {
+        ofstream out(tempFile, ios::binary | ios::trunc);
+        out.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        writeInt(out, minSupport);
+        writeInt(out, totalTransactions);
+        writeItemset(out, constraints.mustInclude);
+        writeItemset(out, constraints.mustExclude);
+        writeInt(out, constraints.maxLength);
+
+        writeInt(out, transactions.size());
+        for (const Transaction& transaction : transactions) {
+            writeInt(out, transaction.custID);
+            writeInt(out, transaction.transID);
+            writeItemset(out, transaction.items);
+        }
+
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    return commitFile(tempFile, filename);
+}
+
+bool saveCheckpointLevel(int level, const ItemsetCountMap& counts, const string& filename) {
+    string target = levelFile(filename, level);
+    string tempFile = target + ".tmp";
+    {
+        ofstream out(tempFile, ios::binary | ios::trunc);
+        out.write(LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+        writeInt(out, level);
+        writeInt(out, counts.size());
+        for (const auto& pair : counts) {
+            writeItemset(out, pair.first);
+            writeInt(out, pair.second);
+        }
+
+        if (!out.flush()) {
+            return false;
+        }
+    }
+    return commitFile(tempFile, target);
+}
+
+// Reads the counts of one level into counts, replacing what was there
+bool loadCheckpointLevel(int level, ItemsetCountMap& counts, const string& filename) {
+    ifstream in(levelFile(filename, level), ios::binary);
+    char magic[sizeof(LEVEL_MAGIC)];
+    int32_t storedLevel, count;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, LEVEL_MAGIC, sizeof(magic)) != 0 ||
+        !readInt(in, storedLevel) || storedLevel != level || !readInt(in, count)) {
+        return false;
+    }
+    counts.clear();
+    for (int i = 0; i < count; ++i) {
+        Itemset itemset;
+        int32_t support;
+        if (!readItemset(in, itemset) || !readInt(in, support)) return false;
+        counts.emplace_hint(counts.end(), itemset, support);
+    }
+    return true;
+}
+
+// Loads the base file and every consecutive level file after it. At least
+// level 1 must be present.
+bool loadCheckpoint(Checkpoint& checkpoint, const string& filename) {
+    ifstream in(filename, ios::binary);
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+
+    int32_t minSupport, totalTransactions, maxLength, count;
+    if (!readInt(in, minSupport) || !readInt(in, totalTransactions) ||
+        !readItemset(in, checkpoint.constraints.mustInclude) || !readItemset(in, checkpoint.constraints.mustExclude) ||
+        !readInt(in, maxLength)) {
+        return false;
+    }
+    checkpoint.minSupport = minSupport;
+    checkpoint.totalTransactions = totalTransactions;
+    checkpoint.constraints.maxLength = maxLength;
+
+    if (!readInt(in, count)) return false;
+    checkpoint.transactions.assign(max(count, 0), Transaction());
+    for (Transaction& transaction : checkpoint.transactions) {
+        int32_t custID, transID;
+        if (!readInt(in, custID) || !readInt(in, transID) || !readItemset(in, transaction.items)) return false;
+        transaction.custID = custID;
+        transaction.transID = transID;
+    }
+
+    // The last level's counts give the frequent itemsets to extend
+    checkpoint.level = 0;
+    checkpoint.itemsetCountMap.clear();
+    ItemsetCountMap counts;
+    while (loadCheckpointLevel(checkpoint.level + 1, counts, filename)) {
+        checkpoint.level++;
+        checkpoint.frequentItemsets = filterFrequentItemsets(counts, minSupport);
+        checkpoint.itemsetCountMap.insert(counts.begin(), counts.end());
+    }
+    return checkpoint.level > 0;
+}
+
+// Removes the base file and its level files. Levels are written in order, so
+// they end at the first missing one.
+void removeCheckpoint(const string& filename) {
+    remove(filename.c_str());
+    for (int level = 1; remove(levelFile(filename, level).c_str()) == 0; ++level) {
+    }
+}
+
+// Serializes checkpoints on a background thread. At most one write is in
+// flight; the next level's counts wait for the previous write to finish.
+class CheckpointWriter {
+private:
+    string filename;
+    int minSupport;
+    int totalTransactions;
+    Constraints constraints;
+    thread worker;
+
+public:
+    CheckpointWriter(const string& filename, int minSupport, int totalTransactions, const Constraints& constraints)
+        : filename(filename), minSupport(minSupport), totalTransactions(totalTransactions), constraints(constraints) {}
+
+    ~CheckpointWriter() {
+        wait();
+    }
+
+    // Takes over the counts of a completed level. Passing transactions writes
+    // the base file first; they are read in the background, so they must not
+    // change until the next write() or wait().
+    void write(int level, ItemsetCountMap counts, const vector<Transaction>* transactions = nullptr) {
+        wait();
+        worker = thread([this, level, counts = move(counts), transactions]() {
+            if ((transactions &&
+                 !saveCheckpointBase(minSupport, totalTransactions, constraints, *transactions, filename)) ||
+                !saveCheckpointLevel(level, counts, filename)) {
+                cerr << "Could not write checkpoint " << filename << endl;
+            }
+        });
+    }
+
+    void wait() {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+};
+
+bool sameConstraints(const Constraints& a, const Constraints& b) {
+    return a.mustInclude == b.mustInclude && a.mustExclude == b.mustExclude && a.maxLength == b.maxLength;
+}
 
 int main(int argc, char* argv[]) {
     if (argc < 4) {
-        cout << "Usage: " << argv[0] << " <dataset> <min_sup> <min_conf>" << endl;
+        cout << "Usage: " << argv[0] << " <dataset> <min_sup> <min_conf>"
+             << " [--include i,j,...] [--exclude i,j,...] [--max-len n]"
+             << " [--checkpoint file] [--resume]" << endl;
         return 1;
     }
 
@@ -164,33 +485,94 @@ int main(int argc, char* argv[]) {
     double minSupPercentage = atof(argv[2]);
     double minConf = atof(argv[3]);
 
-    vector<Transaction> transactions = parseDataset(datasetFile);
-    int totalTransactions = transactions.size();
-    int minSupport = (int)(minSupPercentage * totalTransactions);
+    Constraints constraints;
+    string checkpointFile = datasetFile + ".ckpt";
+    bool resume = false;
+    for (int i = 4; i < argc; ++i) {
+        if (strcmp(argv[i], "--resume") == 0) {
+            resume = true;
+        } else if (i + 1 >= argc) {
+            cout << "Missing value for option: " << argv[i] << endl;
+            return 1;
+        } else if (strcmp(argv[i], "--include") == 0) {
+            constraints.mustInclude = parseItemList(argv[++i]);
+        } else if (strcmp(argv[i], "--exclude") == 0) {
+            constraints.mustExclude = parseItemList(argv[++i]);
+        } else if (strcmp(argv[i], "--max-len") == 0) {
+            constraints.maxLength = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint") == 0) {
+            checkpointFile = argv[++i];
+        } else {
+            cout << "Unknown option: " << argv[i] << endl;
+            return 1;
+        }
+    }
 
-    // Start measuring time
-    clock_t startTime = clock();
+    vector<Transaction> transactions;
+    int totalTransactions;
+    int minSupport;
 
     ItemsetList frequentItemsets;
     ItemsetCountMap itemsetCountMap;
-
-    // Generate 1-itemset candidates
     ItemsetList candidates;
-    for (const Transaction& transaction : transactions) {
-        for (int item : transaction.items) {
-            Itemset candidate = { item };
-            candidates.push_back(candidate);
+    int level = 1;
+
+    Checkpoint checkpoint;
+    if (resume && loadCheckpoint(checkpoint, checkpointFile)) {
+        if (!sameConstraints(checkpoint.constraints, constraints) ||
+            checkpoint.minSupport != (int)(minSupPercentage * checkpoint.totalTransactions)) {
+            cout << "Checkpoint " << checkpointFile << " was written with different options" << endl;
+            return 1;
         }
+        cout << "Resuming from " << checkpointFile << " after level " << checkpoint.level << endl;
+    } else if (resume) {
+        cout << "No usable checkpoint at " << checkpointFile << ", starting from level 1" << endl;
+        resume = false;
+    }
+    if (!resume) {
+        // Level files left by an earlier run would be read back after this one's
+        removeCheckpoint(checkpointFile);
     }
 
-    // Remove duplicates from 1-itemset candidates
-    sort(candidates.begin(), candidates.end());
-    candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+    // Start measuring time
+    clock_t startTime = clock();
 
-    int level = 1;
+    if (resume) {
+        // The checkpoint holds the reduced transactions; the dataset is not re-read.
+        transactions = move(checkpoint.transactions);
+        totalTransactions = checkpoint.totalTransactions;
+        minSupport = checkpoint.minSupport;
+        frequentItemsets = move(checkpoint.frequentItemsets);
+        itemsetCountMap = move(checkpoint.itemsetCountMap);
+        level = checkpoint.level + 1;
+
+        candidates = generateCandidates(frequentItemsets, constraints);
+        pruneCandidates(candidates, itemsetCountMap, constraints);
+    } else {
+        transactions = parseDataset(datasetFile);
+        totalTransactions = transactions.size();
+        minSupport = (int)(minSupPercentage * totalTransactions);
+
+        // Generate 1-itemset candidates
+        for (const Transaction& transaction : transactions) {
+            for (int item : transaction.items) {
+                if (constraints.mustExclude.count(item)) {
+                    continue;
+                }
+                Itemset candidate = { item };
+                candidates.push_back(candidate);
+            }
+        }
+
+        // Remove duplicates from 1-itemset candidates
+        sort(candidates.begin(), candidates.end());
+        candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+
+    CheckpointWriter checkpointWriter(checkpointFile, minSupport, totalTransactions, constraints);
     while (!candidates.empty()) {
         // Count support for each candidate
-        ItemsetCountMap candidateCountMap = countItemsets(candidates, transactions);
+        ItemsetCountMap candidateCountMap = countItemsets(candidates, transactions, constraints);
 
         // Filter candidates by minimum support
         frequentItemsets = filterFrequentItemsets(candidateCountMap, minSupport);
@@ -205,16 +587,25 @@ int main(int argc, char* argv[]) {
             transactions = reduceTransactions(transactions, frequentItemsets);
         }
 
+        // Persist the completed level while the next one is generated and counted.
+        // The transactions no longer change, so they are written once, with level 1.
+        checkpointWriter.write(level, move(candidateCountMap), level == 1 ? &transactions : nullptr);
+
         // Generate next level candidates
-        candidates = generateCandidates(frequentItemsets);
+        candidates = generateCandidates(frequentItemsets, constraints);
 
         // Prune candidates that have infrequent subsets
-        pruneCandidates(candidates, itemsetCountMap);
+        pruneCandidates(candidates, itemsetCountMap, constraints);
 
         level++;
     }
 
+    // A finished run has nothing left to resume.
+    checkpointWriter.wait();
+    removeCheckpoint(checkpointFile);
+
     // Generate association rules
+    countMissingAntecedents(frequentItemsets, transactions, itemsetCountMap);
     generateRules(frequentItemsets, itemsetCountMap, totalTransactions, minConf);
 
     // Stop measuring time and calculate the elapsed time
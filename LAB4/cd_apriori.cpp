@@ -0,0 +1,416 @@
+// Count Distribution Apriori: N worker processes each mmap a slice of a binary
+// transaction file, generate the same C_k and count it locally. Local counts
+// are summed through a POSIX shared-memory segment with a barrier per level.
+//
+// Build: g++ -O2 -pthread cd_apriori.cpp -o cd_apriori -lrt
+// Usage: cd_apriori convert <dataset.txt> <dataset.bin>
+//        cd_apriori mine <dataset.bin> <min_sup> <workers>
+
+#include <iostream>
+#include <vector>
+#include <set>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mining_common.h"
+using namespace std;
+
+typedef vector<int> Itemset;
+typedef vector<Itemset> ItemsetList;
+
+const int MAX_WORKERS = 64;
+
+// Shared between the launcher and all workers; lives in a MAP_SHARED mapping
+// created before fork().
+struct ControlBlock {
+    pthread_barrier_t barrier;
+    int lastSegment; // Highest level whose count segment worker 0 created
+    double countSeconds[MAX_WORKERS];
+    double reduceSeconds[MAX_WORKERS];
+};
+
+// A page-aligned mmap of part of a file.
+struct MappedRange {
+    void* base;
+    size_t length;
+    const char* data;
+};
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int convertDataset(const string& textFile, const string& binaryFile) {
+    ifstream in(textFile);
+    if (!in) {
+        cerr << "Input file could not be opened\n";
+        return 1;
+    }
+
+    vector<uint64_t> offsets(1, 0);
+    vector<int32_t> items;
+    int32_t maxItem = 0;
+    string line;
+    while (getline(in, line)) {
+        istringstream iss(line);
+        int custID, transID, numItems, item;
+        if (!(iss >> custID >> transID >> numItems)) {
+            continue;
+        }
+        set<int> transaction;
+        while (iss >> item) {
+            // Workers index level-1 counters by item
+            if (item < 0) {
+                cerr << "Negative item " << item << " in transaction " << transID << endl;
+                return 1;
+            }
+            transaction.insert(item);
+        }
+        for (int value : transaction) {
+            items.push_back(value);
+            maxItem = max(maxItem, value);
+        }
+        offsets.push_back(items.size());
+    }
+
+    BinaryHeader header;
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.numTransactions = offsets.size() - 1;
+    header.numItems = items.size();
+    header.maxItem = maxItem;
+    header.reserved = 0;
+
+    ofstream out(binaryFile, ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)offsets.data(), offsets.size() * sizeof(uint64_t));
+    out.write((const char*)items.data(), items.size() * sizeof(int32_t));
+    if (!out) {
+        cerr << "Output file could not be written\n";
+        return 1;
+    }
+
+    cout << "Converted " << header.numTransactions << " transactions (" << header.numItems << " items) to "
+         << binaryFile << endl;
+    return 0;
+}
+
+MappedRange mapRange(int fd, size_t offset, size_t length) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t alignedOffset = offset - offset % page;
+    MappedRange range;
+    range.length = length + (offset - alignedOffset);
+    range.base = mmap(nullptr, range.length, PROT_READ, MAP_PRIVATE, fd, alignedOffset);
+    if (range.base == MAP_FAILED) {
+        perror("mmap");
+        _exit(1);
+    }
+    range.data = (const char*)range.base + (offset - alignedOffset);
+    return range;
+}
+
+// Join L_{k-1} itemsets sharing their first k-2 items, then drop candidates
+// with an infrequent (k-1)-subset. Every worker runs this on the same input,
+// so all of them hold an identical C_k without exchanging it.
+ItemsetList generateCandidates(const ItemsetList& prevFrequentItemsets) {
+    ItemsetList candidates;
+    set<Itemset> frequent(prevFrequentItemsets.begin(), prevFrequentItemsets.end());
+    int size = prevFrequentItemsets.size();
+
+    for (int i = 0; i < size; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+            const Itemset& a = prevFrequentItemsets[i];
+            const Itemset& b = prevFrequentItemsets[j];
+            if (!equal(a.begin(), a.end() - 1, b.begin())) {
+                break;
+            }
+
+            Itemset candidate = a;
+            candidate.push_back(b.back());
+
+            bool allSubsetsFrequent = true;
+            for (size_t skip = 0; skip + 2 < candidate.size() && allSubsetsFrequent; ++skip) {
+                Itemset subset;
+                for (size_t m = 0; m < candidate.size(); ++m) {
+                    if (m != skip) subset.push_back(candidate[m]);
+                }
+                allSubsetsFrequent = frequent.count(subset) > 0;
+            }
+            if (allSubsetsFrequent) {
+                candidates.push_back(candidate);
+            }
+        }
+    }
+
+    return candidates;
+}
+
+string segmentName(pid_t launcher, int level) {
+    return "/cd_apriori_" + to_string(launcher) + "_" + to_string(level);
+}
+
+// Worker 0 creates the level's count segment; the others attach after the
+// barrier. Each worker owns one row of numCandidates counters.
+uint32_t* attachCountSegment(const string& name, int level, int workerID, size_t bytes, ControlBlock* control) {
+    if (workerID == 0) {
+        control->lastSegment = level;
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 || ftruncate(fd, bytes) != 0) {
+            perror("shm_open");
+            _exit(1);
+        }
+        close(fd);
+    }
+    pthread_barrier_wait(&control->barrier);
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        perror("shm_open");
+        _exit(1);
+    }
+    void* counts = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (counts == MAP_FAILED) {
+        perror("mmap");
+        _exit(1);
+    }
+    return (uint32_t*)counts;
+}
+
+void runWorker(int workerID, int numWorkers, const string& binaryFile, int minSupport, ControlBlock* control) {
+    int fd = open(binaryFile.c_str(), O_RDONLY);
+    BinaryHeader header;
+    if (fd < 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+        perror("open");
+        _exit(1);
+    }
+
+    // This worker's slice of the transactions.
+    uint64_t n = header.numTransactions;
+    uint64_t first = n * workerID / numWorkers;
+    uint64_t last = n * (workerID + 1) / numWorkers;
+
+    size_t offsetsStart = sizeof(BinaryHeader);
+    MappedRange offsetRange = mapRange(fd, offsetsStart + first * sizeof(uint64_t), (last - first + 1) * sizeof(uint64_t));
+    const uint64_t* offsets = (const uint64_t*)offsetRange.data;
+
+    size_t itemsStart = offsetsStart + (n + 1) * sizeof(uint64_t);
+    size_t sliceItems = offsets[last - first] - offsets[0];
+    MappedRange itemRange = mapRange(fd, itemsStart + offsets[0] * sizeof(int32_t), max<size_t>(sliceItems, 1) * sizeof(int32_t));
+    const int32_t* items = (const int32_t*)itemRange.data;
+    close(fd);
+
+    ItemsetList candidates;
+    for (int item = 0; item <= header.maxItem; ++item) {
+        candidates.push_back({item});
+    }
+
+    ItemsetList allFrequent;
+    vector<uint32_t> allCounts;
+    auto totalStart = chrono::steady_clock::now();
+    int level = 1;
+
+    while (!candidates.empty()) {
+        string name = segmentName(getppid(), level);
+        size_t numCandidates = candidates.size();
+        uint32_t* counts = attachCountSegment(name, level, workerID, numWorkers * numCandidates * sizeof(uint32_t), control);
+        uint32_t* local = counts + workerID * numCandidates;
+
+        // Count C_k over the local slice.
+        auto countStart = chrono::steady_clock::now();
+        for (uint64_t t = 0; t < last - first; ++t) {
+            const int32_t* begin = items + (offsets[t] - offsets[0]);
+            const int32_t* end = items + (offsets[t + 1] - offsets[0]);
+            if (level == 1) {
+                for (const int32_t* it = begin; it != end; ++it) {
+                    local[*it]++;
+                }
+                continue;
+            }
+            if (end - begin < level) {
+                continue;
+            }
+            for (size_t c = 0; c < numCandidates; ++c) {
+                if (includes(begin, end, candidates[c].begin(), candidates[c].end())) {
+                    local[c]++;
+                }
+            }
+        }
+        control->countSeconds[workerID] = secondsSince(countStart);
+
+        // Reduce: once every row is written, each worker sums all rows.
+        auto reduceStart = chrono::steady_clock::now();
+        pthread_barrier_wait(&control->barrier);
+        ItemsetList frequent;
+        for (size_t c = 0; c < numCandidates; ++c) {
+            uint32_t total = 0;
+            for (int w = 0; w < numWorkers; ++w) {
+                total += counts[w * numCandidates + c];
+            }
+            if ((int)total >= minSupport) {
+                frequent.push_back(candidates[c]);
+                allCounts.push_back(total);
+            }
+        }
+        control->reduceSeconds[workerID] = secondsSince(reduceStart);
+        pthread_barrier_wait(&control->barrier);
+
+        munmap(counts, numWorkers * numCandidates * sizeof(uint32_t));
+        if (workerID == 0) {
+            shm_unlink(name.c_str());
+        }
+
+        ostringstream timing;
+        timing << "Worker " << workerID << " Level " << level << " - Transactions: " << (last - first)
+               << ", Candidates: " << numCandidates << ", Count: " << control->countSeconds[workerID]
+               << " s, Reduce: " << control->reduceSeconds[workerID] << " s\n";
+        cout << timing.str() << flush;
+
+        if (workerID == 0) {
+            cout << "Level " << level << " - Candidates: " << numCandidates << ", Frequent Itemsets: "
+                 << frequent.size() << endl;
+        }
+
+        allFrequent.insert(allFrequent.end(), frequent.begin(), frequent.end());
+        candidates = generateCandidates(frequent);
+        level++;
+    }
+
+    ostringstream summary;
+    summary << "Worker " << workerID << " done in " << secondsSince(totalStart) << " s\n";
+    cout << summary.str() << flush;
+
+    if (workerID == 0) {
+        for (size_t i = 0; i < allFrequent.size(); ++i) {
+            cout << "{ ";
+            for (int item : allFrequent[i]) {
+                cout << item << " ";
+            }
+            cout << "} (Sup: " << allCounts[i] << ")" << endl;
+        }
+    }
+
+    munmap(offsetRange.base, offsetRange.length);
+    munmap(itemRange.base, itemRange.length);
+}
+
+int mineDataset(const string& binaryFile, double minSupPercentage, int numWorkers) {
+    BinaryHeader header;
+    ifstream in(binaryFile, ios::binary);
+    if (!in.read((char*)&header, sizeof(header)) || memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0) {
+        cerr << "Not a binary transaction file: " << binaryFile << endl;
+        return 1;
+    }
+    if (numWorkers < 1 || numWorkers > MAX_WORKERS) {
+        cerr << "Worker count must be between 1 and " << MAX_WORKERS << endl;
+        return 1;
+    }
+    int minSupport = (int)(minSupPercentage * header.numTransactions);
+
+    void* shared = mmap(nullptr, sizeof(ControlBlock), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    ControlBlock* control = (ControlBlock*)shared;
+    control->lastSegment = 0;
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&control->barrier, &attr, numWorkers);
+    pthread_barrierattr_destroy(&attr);
+
+    auto start = chrono::steady_clock::now();
+    cout << "Transactions: " << header.numTransactions << ", Workers: " << numWorkers << ", Min Support: " << minSupport
+         << endl;
+
+    // Launch the workers. Without all of them the first barrier never opens.
+    vector<pid_t> workers;
+    int failures = 0;
+    for (int w = 0; w < numWorkers && !failures; ++w) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            failures++;
+        } else if (pid == 0) {
+            runWorker(w, numWorkers, binaryFile, minSupport, control);
+            _exit(0);
+        } else {
+            workers.push_back(pid);
+        }
+    }
+
+    // Reap workers as they exit. A worker that fails leaves the others blocked
+    // at the next barrier, so they are killed. Entries are cleared once reaped,
+    // so no recycled pid is signalled.
+    if (failures) {
+        for (pid_t pid : workers) kill(pid, SIGKILL);
+    }
+    for (size_t running = workers.size(); running > 0;) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            perror("waitpid");
+            break;
+        }
+        auto it = find(workers.begin(), workers.end(), pid);
+        if (it == workers.end()) continue;
+        *it = 0;
+        running--;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (failures++ == 0) {
+                cerr << "Worker " << (it - workers.begin()) << " failed, stopping the others" << endl;
+                for (pid_t other : workers) {
+                    if (other > 0) kill(other, SIGKILL);
+                }
+            }
+        }
+    }
+
+    // A killed worker 0 cannot unlink its last count segment.
+    if (failures) {
+        for (int level = 1; level <= control->lastSegment; ++level) {
+            shm_unlink(segmentName(getpid(), level).c_str());
+        }
+    }
+
+    // Destroying a barrier that killed workers were waiting at blocks forever;
+    // unmapping it is enough.
+    if (!failures) {
+        pthread_barrier_destroy(&control->barrier);
+    }
+    munmap(shared, sizeof(ControlBlock));
+
+    cout << "Execution Time: " << secondsSince(start) << " seconds" << endl;
+    if (failures) {
+        cerr << failures << " worker(s) failed" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "convert") == 0) {
+        return convertDataset(argv[2], argv[3]);
+    }
+    if (argc == 5 && strcmp(argv[1], "mine") == 0) {
+        return mineDataset(argv[2], atof(argv[3]), atoi(argv[4]));
+    }
+
+    cout << "Usage: " << argv[0] << " convert <dataset.txt> <dataset.bin>" << endl;
+    cout << "       " << argv[0] << " mine <dataset.bin> <min_sup> <workers>" << endl;
+    return 1;
+}
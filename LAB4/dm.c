@@ -0,0 +1,923 @@
+#include "dm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Allocation
+
+static void *std_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *std_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    (void)ctx;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+static void std_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+static const dm_allocator default_allocator = { std_alloc, std_realloc, std_free, NULL };
+
+static dm_allocator pick_allocator(const dm_allocator *alloc) {
+    return alloc ? *alloc : default_allocator;
+}
+
+// Zero-sized requests are rounded up so every block has a distinct address
+static size_t block_size(size_t count, size_t elem) {
+    return count && elem ? count * elem : 1;
+}
+
+static void *mem_alloc(const dm_allocator *a, size_t count, size_t elem) {
+    if (count && elem > (size_t)-1 / count) return NULL;
+    return a->alloc(a->ctx, block_size(count, elem));
+}
+
+static void mem_free(const dm_allocator *a, void *ptr, size_t count, size_t elem) {
+    if (ptr) a->free(a->ctx, ptr, block_size(count, elem));
+}
+
+// Grows an array of *cap elements to hold at least need; capacity doubles
+static dm_status mem_reserve(const dm_allocator *a, void **ptr, size_t *cap, size_t need, size_t elem) {
+    if (need <= *cap && *ptr) return DM_OK;
+    size_t new_cap = *cap ? *cap : 16;
+    while (new_cap < need) {
+        if (new_cap > (size_t)-1 / 2 / elem) return DM_ENOMEM;
+        new_cap *= 2;
+    }
+    void *grown = *ptr ? a->realloc(a->ctx, *ptr, block_size(*cap, elem), new_cap * elem)
+                       : a->alloc(a->ctx, new_cap * elem);
+    if (!grown) return DM_ENOMEM;
+    *ptr = grown;
+    *cap = new_cap;
+    return DM_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Itemset helpers
+
+static int compare_int32(const void *a, const void *b) {
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Sorts and de-duplicates items in place, returning the new length
+static size_t normalize_items(int32_t *items, size_t n) {
+    if (n < 2) return n;
+    qsort(items, n, sizeof(int32_t), compare_int32);
+    size_t out = 1;
+    for (size_t i = 1; i < n; i++) {
+        if (items[i] != items[out - 1]) items[out++] = items[i];
+    }
+    return out;
+}
+
+// True if sorted sub[0..k) is contained in sorted set[0..n)
+static int is_subset(const int32_t *sub, size_t k, const int32_t *set, size_t n) {
+    size_t i = 0, j = 0;
+    while (i < k && j < n) {
+        if (set[j] < sub[i]) j++;
+        else if (set[j] == sub[i]) i++, j++;
+        else return 0;
+    }
+    return i == k;
+}
+
+static uint64_t hash_items(const int32_t *items, size_t k) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ k;
+    for (size_t i = 0; i < k; i++) {
+        h ^= (uint32_t)items[i];
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+// True if C(n, k) <= limit
+static int binomial_at_most(size_t n, size_t k, size_t limit) {
+    double c = 1;
+    for (size_t i = 0; i < k; i++) {
+        c = c * (double)(n - i) / (double)(i + 1);
+        if (c > (double)limit) return 0;
+    }
+    return 1;
+}
+
+// Advances idx to the next k-combination of 0..n-1; returns 0 after the last
+static int next_combination(size_t *idx, size_t n, size_t k) {
+    size_t i = k;
+    while (i > 0 && idx[i - 1] == n - k + i - 1) i--;
+    if (i == 0) return 0;
+    idx[i - 1]++;
+    for (size_t j = i; j < k; j++) idx[j] = idx[j - 1] + 1;
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Growable open-addressing table of fixed-size itemsets. Entries are appended
+// and never move between indices, so callers may keep per-entry side arrays.
+
+typedef struct {
+    const dm_allocator *alloc;
+    size_t k;
+    size_t count;
+    int32_t *items;     // k per entry
+    uint32_t *counts;
+    size_t items_cap;
+    size_t counts_cap;
+    uint32_t *slots;    // entry index + 1, 0 marks an empty slot
+    size_t num_slots;   // power of two
+} itemset_table;
+
+#define NOT_FOUND ((size_t)-1)
+
+static dm_status table_init(itemset_table *t, const dm_allocator *alloc, size_t k) {
+    memset(t, 0, sizeof(*t));
+    t->alloc = alloc;
+    t->k = k;
+    t->num_slots = 64;
+    t->slots = mem_alloc(alloc, t->num_slots, sizeof(uint32_t));
+    if (!t->slots) return DM_ENOMEM;
+    memset(t->slots, 0, t->num_slots * sizeof(uint32_t));
+    return DM_OK;
+}
+
+static void table_free(itemset_table *t) {
+    mem_free(t->alloc, t->items, t->items_cap, sizeof(int32_t));
+    mem_free(t->alloc, t->counts, t->counts_cap, sizeof(uint32_t));
+    mem_free(t->alloc, t->slots, t->num_slots, sizeof(uint32_t));
+    memset(t, 0, sizeof(*t));
+}
+
+static const int32_t *table_items(const itemset_table *t, size_t entry) {
+    return t->items + entry * t->k;
+}
+
+static size_t table_find(const itemset_table *t, const int32_t *items) {
+    size_t mask = t->num_slots - 1;
+    for (size_t pos = hash_items(items, t->k) & mask;; pos = (pos + 1) & mask) {
+        uint32_t slot = t->slots[pos];
+        if (!slot) return NOT_FOUND;
+        if (memcmp(table_items(t, slot - 1), items, t->k * sizeof(int32_t)) == 0) return slot - 1;
+    }
+}
+
+static dm_status table_rehash(itemset_table *t) {
+    size_t num_slots = t->num_slots * 2;
+    uint32_t *slots = mem_alloc(t->alloc, num_slots, sizeof(uint32_t));
+    if (!slots) return DM_ENOMEM;
+    memset(slots, 0, num_slots * sizeof(uint32_t));
+    for (size_t e = 0; e < t->count; e++) {
+        size_t pos = hash_items(table_items(t, e), t->k) & (num_slots - 1);
+        while (slots[pos]) pos = (pos + 1) & (num_slots - 1);
+        slots[pos] = (uint32_t)(e + 1);
+    }
+    mem_free(t->alloc, t->slots, t->num_slots, sizeof(uint32_t));
+    t->slots = slots;
+    t->num_slots = num_slots;
+    return DM_OK;
+}
+
+// Finds items or adds them with a zero count; *entry receives the index
+static dm_status table_insert(itemset_table *t, const int32_t *items, size_t *entry) {
+    size_t found = table_find(t, items);
+    if (found != NOT_FOUND) {
+        *entry = found;
+        return DM_OK;
+    }
+    if (t->count >= UINT32_MAX - 1) return DM_ENOMEM;
+    if ((t->count + 1) * 10 > t->num_slots * 7) {
+        dm_status status = table_rehash(t);
+        if (status != DM_OK) return status;
+    }
+
+    // Entries are appended, so items and counts only ever grow
+    dm_status status = mem_reserve(t->alloc, (void **)&t->items, &t->items_cap, (t->count + 1) * t->k, sizeof(int32_t));
+    if (status == DM_OK) status = mem_reserve(t->alloc, (void **)&t->counts, &t->counts_cap, t->count + 1, sizeof(uint32_t));
+    if (status != DM_OK) return status;
+
+    size_t e = t->count++;
+    memcpy(t->items + e * t->k, items, t->k * sizeof(int32_t));
+    t->counts[e] = 0;
+    size_t mask = t->num_slots - 1;
+    size_t pos = hash_items(items, t->k) & mask;
+    while (t->slots[pos]) pos = (pos + 1) & mask;
+    t->slots[pos] = (uint32_t)(e + 1);
+    *entry = e;
+    return DM_OK;
+}
+
+// Scratch space for walking the k-combinations of a transaction
+typedef struct {
+    size_t *idx;
+    int32_t *combo;
+    size_t k;
+} combo_scratch;
+
+static dm_status scratch_init(combo_scratch *s, const dm_allocator *alloc, size_t k) {
+    s->k = k;
+    s->idx = mem_alloc(alloc, k, sizeof(size_t));
+    s->combo = mem_alloc(alloc, k, sizeof(int32_t));
+    return s->idx && s->combo ? DM_OK : DM_ENOMEM;
+}
+
+static void scratch_free(combo_scratch *s, const dm_allocator *alloc) {
+    mem_free(alloc, s->idx, s->k, sizeof(size_t));
+    mem_free(alloc, s->combo, s->k, sizeof(int32_t));
+}
+
+typedef void (*entry_visit)(void *ctx, const itemset_table *t, size_t entry);
+
+// Calls visit for every entry of t contained in the sorted transaction. Short
+// transactions look up each of their k-combinations; long ones test entries.
+static void for_each_contained(const itemset_table *t, const int32_t *tx, size_t n, combo_scratch *s,
+                               entry_visit visit, void *ctx) {
+    size_t k = t->k;
+    if (n < k || t->count == 0) return;
+
+    if (!binomial_at_most(n, k, t->count)) {
+        for (size_t e = 0; e < t->count; e++) {
+            if (is_subset(table_items(t, e), k, tx, n)) visit(ctx, t, e);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < k; i++) s->idx[i] = i;
+    do {
+        for (size_t i = 0; i < k; i++) s->combo[i] = tx[s->idx[i]];
+        size_t e = table_find(t, s->combo);
+        if (e != NOT_FOUND) visit(ctx, t, e);
+    } while (next_combination(s->idx, n, k));
+}
+
+static void increment_count(void *ctx, const itemset_table *t, size_t entry) {
+    (void)ctx;
+    t->counts[entry]++;
+}
+
+static const int32_t *tx_items(const dm_txdb *db, size_t t) {
+    return db->items + db->offsets[t];
+}
+
+static size_t tx_length(const dm_txdb *db, size_t t) {
+    return db->offsets[t + 1] - db->offsets[t];
+}
+
+// ---------------------------------------------------------------------------
+// Transaction database
+
+dm_status dm_txdb_init(dm_txdb *db, const dm_allocator *alloc) {
+    memset(db, 0, sizeof(*db));
+    db->alloc = pick_allocator(alloc);
+    dm_status status = mem_reserve(&db->alloc, (void **)&db->offsets, &db->offsets_cap, 1, sizeof(size_t));
+    if (status != DM_OK) return status;
+    db->offsets[0] = 0;
+    return DM_OK;
+}
+
+void dm_txdb_free(dm_txdb *db) {
+    mem_free(&db->alloc, db->offsets, db->offsets_cap, sizeof(size_t));
+    mem_free(&db->alloc, db->items, db->items_cap, sizeof(int32_t));
+    memset(db, 0, sizeof(*db));
+}
+
+dm_status dm_txdb_add(dm_txdb *db, const int32_t *items, size_t n) {
+    dm_status status = mem_reserve(&db->alloc, (void **)&db->items, &db->items_cap, db->num_items + n, sizeof(int32_t));
+    if (status == DM_OK) {
+        status = mem_reserve(&db->alloc, (void **)&db->offsets, &db->offsets_cap, db->num_transactions + 2, sizeof(size_t));
+    }
+    if (status != DM_OK) return status;
+
+    int32_t *tail = db->items + db->num_items;
+    memcpy(tail, items, n * sizeof(int32_t));
+    n = normalize_items(tail, n);
+    for (size_t i = 0; i < n; i++) {
+        if (tail[i] > db->max_item) db->max_item = tail[i];
+    }
+    db->num_items += n;
+    db->offsets[++db->num_transactions] = db->num_items;
+    return DM_OK;
+}
+
+// Accumulates the integers of the current input line
+typedef struct {
+    int64_t value;
+    int in_number;
+    int negative;
+    int32_t *line;
+    size_t len;
+    size_t cap;
+    size_t skip; // leading fields that are not items
+} line_parser;
+
+static dm_status parser_feed(dm_txdb *db, line_parser *p, char c) {
+    if (c >= '0' && c <= '9') {
+        p->value = p->value * 10 + (c - '0');
+        p->in_number = 1;
+        return DM_OK;
+    }
+    if (p->in_number) {
+        dm_status status = mem_reserve(&db->alloc, (void **)&p->line, &p->cap, p->len + 1, sizeof(int32_t));
+        if (status != DM_OK) return status;
+        p->line[p->len++] = (int32_t)(p->negative ? -p->value : p->value);
+    }
+    p->value = 0;
+    p->in_number = 0;
+    p->negative = c == '-';
+
+    if (c == '\n') {
+        size_t len = p->len;
+        p->len = 0;
+        if (len > p->skip) return dm_txdb_add(db, p->line + p->skip, len - p->skip);
+    }
+    return DM_OK;
+}
+
+// Reads the file through a fixed buffer, so line length is unbounded
+dm_status dm_txdb_load(dm_txdb *db, const char *path, dm_format format, const dm_allocator *alloc) {
+    dm_status status = dm_txdb_init(db, alloc);
+    if (status != DM_OK) return status;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        dm_txdb_free(db);
+        return DM_EIO;
+    }
+
+    const size_t buffer_size = 1 << 16;
+    char *buffer = mem_alloc(&db->alloc, buffer_size, 1);
+    line_parser parser;
+    memset(&parser, 0, sizeof(parser));
+    parser.skip = format == DM_FORMAT_CUST_TRANS ? 3 : 0;
+    if (!buffer) status = DM_ENOMEM;
+
+    while (status == DM_OK) {
+        size_t got = fread(buffer, 1, buffer_size, file);
+        if (got == 0) {
+            if (ferror(file)) status = DM_EIO;
+            break;
+        }
+        for (size_t i = 0; i < got && status == DM_OK; i++) {
+            status = parser_feed(db, &parser, buffer[i]);
+        }
+    }
+    // Flush an unterminated last line
+    if (status == DM_OK) status = parser_feed(db, &parser, '\n');
+
+    fclose(file);
+    mem_free(&db->alloc, buffer, buffer_size, 1);
+    mem_free(&db->alloc, parser.line, parser.cap, sizeof(int32_t));
+    if (status != DM_OK) dm_txdb_free(db);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Results
+
+dm_status dm_itemsets_init(dm_itemsets *out, const dm_allocator *alloc) {
+    memset(out, 0, sizeof(*out));
+    out->alloc = pick_allocator(alloc);
+    dm_status status = mem_reserve(&out->alloc, (void **)&out->offsets, &out->offsets_cap, 1, sizeof(size_t));
+    if (status != DM_OK) return status;
+    out->offsets[0] = 0;
+    return DM_OK;
+}
+
+void dm_itemsets_free(dm_itemsets *out) {
+    mem_free(&out->alloc, out->offsets, out->offsets_cap, sizeof(size_t));
+    mem_free(&out->alloc, out->items, out->items_cap, sizeof(int32_t));
+    mem_free(&out->alloc, out->support, out->support_cap, sizeof(uint32_t));
+    memset(out, 0, sizeof(*out));
+}
+
+static dm_status itemsets_append(dm_itemsets *out, const int32_t *items, size_t k, uint32_t support) {
+    size_t used = out->offsets[out->count];
+    dm_status status = mem_reserve(&out->alloc, (void **)&out->items, &out->items_cap, used + k, sizeof(int32_t));
+    if (status == DM_OK) status = mem_reserve(&out->alloc, (void **)&out->offsets, &out->offsets_cap, out->count + 2, sizeof(size_t));
+    if (status == DM_OK) status = mem_reserve(&out->alloc, (void **)&out->support, &out->support_cap, out->count + 1, sizeof(uint32_t));
+    if (status != DM_OK) return status;
+    memcpy(out->items + used, items, k * sizeof(int32_t));
+    out->support[out->count] = support;
+    out->offsets[++out->count] = used + k;
+    return DM_OK;
+}
+
+static dm_status append_frequent(const itemset_table *t, uint32_t min_count, dm_itemsets *out) {
+    for (size_t e = 0; e < t->count; e++) {
+        if (t->counts[e] >= min_count) {
+            dm_status status = itemsets_append(out, table_items(t, e), t->k, t->counts[e]);
+            if (status != DM_OK) return status;
+        }
+    }
+    return DM_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Hash counting
+
+dm_status dm_hash_count(const dm_txdb *db, size_t k, uint32_t min_count, dm_itemsets *out) {
+    if (k == 0) return DM_EINVAL;
+
+    const dm_allocator *alloc = &db->alloc;
+    itemset_table table;
+    combo_scratch scratch = { NULL, NULL, k };
+    dm_status status = table_init(&table, alloc, k);
+    if (status == DM_OK) status = scratch_init(&scratch, alloc, k);
+
+    for (size_t t = 0; t < db->num_transactions && status == DM_OK; t++) {
+        const int32_t *tx = tx_items(db, t);
+        size_t n = tx_length(db, t);
+        if (n < k) continue;
+
+        for (size_t i = 0; i < k; i++) scratch.idx[i] = i;
+        do {
+            for (size_t i = 0; i < k; i++) scratch.combo[i] = tx[scratch.idx[i]];
+            size_t entry;
+            status = table_insert(&table, scratch.combo, &entry);
+            if (status != DM_OK) break;
+            table.counts[entry]++;
+        } while (next_combination(scratch.idx, n, k));
+    }
+
+    if (status == DM_OK) status = append_frequent(&table, min_count, out);
+    scratch_free(&scratch, alloc);
+    table_free(&table);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Level-wise mining over a range of transactions
+
+typedef struct {
+    const int32_t *items;
+    size_t k;
+} itemset_ref;
+
+static int compare_refs(const void *a, const void *b) {
+    const itemset_ref *x = a, *y = b;
+    for (size_t i = 0; i < x->k; i++) {
+        if (x->items[i] != y->items[i]) return x->items[i] < y->items[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Builds C_{k+1} from the frequent entries of prev by prefix join and subset pruning
+static dm_status generate_candidates(const itemset_table *prev, uint32_t min_count, itemset_table *next) {
+    const dm_allocator *alloc = prev->alloc;
+    size_t k = prev->k;
+    size_t num_frequent = 0;
+    for (size_t e = 0; e < prev->count; e++) {
+        if (prev->counts[e] >= min_count) num_frequent++;
+    }
+
+    itemset_ref *refs = mem_alloc(alloc, num_frequent, sizeof(itemset_ref));
+    int32_t *candidate = mem_alloc(alloc, k + 1, sizeof(int32_t));
+    int32_t *subset = mem_alloc(alloc, k, sizeof(int32_t));
+    dm_status status = refs && candidate && subset ? DM_OK : DM_ENOMEM;
+
+    if (status == DM_OK) {
+        size_t r = 0;
+        for (size_t e = 0; e < prev->count; e++) {
+            if (prev->counts[e] >= min_count) {
+                refs[r].items = table_items(prev, e);
+                refs[r++].k = k;
+            }
+        }
+        qsort(refs, num_frequent, sizeof(itemset_ref), compare_refs);
+    }
+
+    for (size_t i = 0; i < num_frequent && status == DM_OK; i++) {
+        for (size_t j = i + 1; j < num_frequent && status == DM_OK; j++) {
+            if (memcmp(refs[i].items, refs[j].items, (k - 1) * sizeof(int32_t)) != 0) break;
+            memcpy(candidate, refs[i].items, k * sizeof(int32_t));
+            candidate[k] = refs[j].items[k - 1];
+
+            int all_frequent = 1;
+            for (size_t skip = 0; skip + 1 < k && all_frequent; skip++) {
+                for (size_t m = 0, s = 0; m <= k; m++) {
+                    if (m != skip) subset[s++] = candidate[m];
+                }
+                size_t e = table_find(prev, subset);
+                all_frequent = e != NOT_FOUND && prev->counts[e] >= min_count;
+            }
+            if (all_frequent) {
+                size_t entry;
+                status = table_insert(next, candidate, &entry);
+            }
+        }
+    }
+
+    mem_free(alloc, refs, num_frequent, sizeof(itemset_ref));
+    mem_free(alloc, candidate, k + 1, sizeof(int32_t));
+    mem_free(alloc, subset, k, sizeof(int32_t));
+    return status;
+}
+
+static dm_status count_range(const dm_txdb *db, size_t begin, size_t end, itemset_table *t) {
+    combo_scratch scratch;
+    dm_status status = scratch_init(&scratch, &db->alloc, t->k);
+    if (status == DM_OK) {
+        for (size_t tx = begin; tx < end; tx++) {
+            for_each_contained(t, tx_items(db, tx), tx_length(db, tx), &scratch, increment_count, NULL);
+        }
+    }
+    scratch_free(&scratch, &db->alloc);
+    return status;
+}
+
+// Counts tables[1..max_k] in a single pass over transactions [begin, end)
+static dm_status count_range_levels(const dm_txdb *db, size_t begin, size_t end, itemset_table *tables,
+                                    size_t max_k) {
+    // Scratch sized for max_k serves every smaller k
+    combo_scratch scratch;
+    dm_status status = scratch_init(&scratch, &db->alloc, max_k);
+    if (status == DM_OK) {
+        for (size_t tx = begin; tx < end; tx++) {
+            for (size_t k = 1; k <= max_k; k++) {
+                for_each_contained(&tables[k], tx_items(db, tx), tx_length(db, tx), &scratch, increment_count, NULL);
+            }
+        }
+    }
+    scratch_free(&scratch, &db->alloc);
+    return status;
+}
+
+// Apriori over transactions [begin, end): appends every itemset occurring in
+// at least min_count of them to out
+static dm_status apriori_range(const dm_txdb *db, size_t begin, size_t end, uint32_t min_count, dm_itemsets *out) {
+    const dm_allocator *alloc = &db->alloc;
+    itemset_table level;
+    dm_status status = table_init(&level, alloc, 1);
+
+    for (size_t t = begin; t < end && status == DM_OK; t++) {
+        const int32_t *tx = tx_items(db, t);
+        for (size_t i = 0; i < tx_length(db, t) && status == DM_OK; i++) {
+            size_t entry;
+            status = table_insert(&level, &tx[i], &entry);
+            if (status == DM_OK) level.counts[entry]++;
+        }
+    }
+
+    while (status == DM_OK && level.count > 0) {
+        status = append_frequent(&level, min_count, out);
+        itemset_table next;
+        if (status == DM_OK) status = table_init(&next, alloc, level.k + 1);
+        if (status != DM_OK) break;
+
+        status = generate_candidates(&level, min_count, &next);
+        if (status == DM_OK) status = count_range(db, begin, end, &next);
+        table_free(&level);
+        level = next;
+    }
+
+    table_free(&level);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Partition
+
+// Local threshold of a partition of size transactions. An itemset below it in
+// every partition occurs at most sum(threshold - 1) <= min_count - 1 times,
+// so no globally frequent itemset is lost.
+static uint32_t local_threshold(uint32_t min_count, size_t size, size_t n) {
+    uint64_t count = n ? (uint64_t)min_count * size / n : 0;
+    return count < 1 ? 1 : (uint32_t)count;
+}
+
+dm_status dm_partition_mine(const dm_txdb *db, size_t num_partitions, uint32_t min_count, dm_itemsets *out) {
+    if (num_partitions == 0) return DM_EINVAL;
+    size_t n = db->num_transactions;
+    if (num_partitions > n) num_partitions = n ? n : 1;
+
+    // Phase 1: locally frequent itemsets of every partition
+    dm_itemsets local;
+    dm_status status = dm_itemsets_init(&local, &db->alloc);
+    for (size_t p = 0; p < num_partitions && status == DM_OK; p++) {
+        size_t begin = n * p / num_partitions, end = n * (p + 1) / num_partitions;
+        status = apriori_range(db, begin, end, local_threshold(min_count, end - begin, n), &local);
+    }
+
+    // Phase 2: one global scan over the union, grouped by itemset size
+    size_t max_k = 0;
+    for (size_t i = 0; i < local.count; i++) {
+        size_t k = local.offsets[i + 1] - local.offsets[i];
+        if (k > max_k) max_k = k;
+    }
+    itemset_table *tables = status == DM_OK ? mem_alloc(&db->alloc, max_k + 1, sizeof(itemset_table)) : NULL;
+    if (status == DM_OK && !tables) status = DM_ENOMEM;
+    size_t initialized = 0;
+    for (; status == DM_OK && initialized <= max_k; initialized++) {
+        status = table_init(&tables[initialized], &db->alloc, initialized ? initialized : 1);
+    }
+
+    for (size_t i = 0; i < local.count && status == DM_OK; i++) {
+        size_t entry;
+        size_t k = local.offsets[i + 1] - local.offsets[i];
+        status = table_insert(&tables[k], local.items + local.offsets[i], &entry);
+    }
+
+    if (status == DM_OK && max_k > 0) status = count_range_levels(db, 0, n, tables, max_k);
+    for (size_t k = 1; k <= max_k && status == DM_OK; k++) {
+        status = append_frequent(&tables[k], min_count, out);
+    }
+
+    for (size_t k = 0; k < initialized; k++) table_free(&tables[k]);
+    if (tables) mem_free(&db->alloc, tables, max_k + 1, sizeof(itemset_table));
+    dm_itemsets_free(&local);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Dynamic Itemset Counting
+
+#define DIC_BOX 1      // reached min_count: its supersets may start counting
+#define DIC_SOLID 2    // counted over the whole database
+#define DIC_EXTENDED 4 // supersets already generated
+
+typedef struct {
+    itemset_table table;
+    size_t *seen;      // transactions counted so far
+    uint8_t *flags;
+    size_t meta_cap;
+    combo_scratch scratch;
+} dic_level;
+
+typedef struct {
+    const dm_allocator *alloc;
+    dic_level *levels; // levels[k] holds k-itemsets; index 0 unused
+    size_t num_levels;
+    size_t levels_cap;
+    size_t active;     // itemsets still counting
+} dic_state;
+
+static dm_status dic_level_for(dic_state *dic, size_t k, dic_level **level) {
+    while (k >= dic->num_levels) {
+        dm_status status = mem_reserve(dic->alloc, (void **)&dic->levels, &dic->levels_cap, dic->num_levels + 1, sizeof(dic_level));
+        if (status != DM_OK) return status;
+        dic_level *added = &dic->levels[dic->num_levels];
+        memset(added, 0, sizeof(*added));
+        size_t size = dic->num_levels ? dic->num_levels : 1;
+        status = table_init(&added->table, dic->alloc, size);
+        if (status == DM_OK) status = scratch_init(&added->scratch, dic->alloc, size);
+        dic->num_levels++;
+        if (status != DM_OK) return status;
+    }
+    *level = &dic->levels[k];
+    return DM_OK;
+}
+
+static dm_status dic_add(dic_state *dic, const int32_t *items, size_t k) {
+    dic_level *level;
+    dm_status status = dic_level_for(dic, k, &level);
+    if (status != DM_OK) return status;
+
+    size_t before = level->table.count, entry;
+    status = table_insert(&level->table, items, &entry);
+    if (status != DM_OK || level->table.count == before) return status;
+
+    size_t seen_cap = level->meta_cap, flags_cap = level->meta_cap;
+    status = mem_reserve(dic->alloc, (void **)&level->seen, &seen_cap, entry + 1, sizeof(size_t));
+    if (status == DM_OK) status = mem_reserve(dic->alloc, (void **)&level->flags, &flags_cap, seen_cap, sizeof(uint8_t));
+    if (status != DM_OK) return status;
+    level->meta_cap = seen_cap;
+    level->seen[entry] = 0;
+    level->flags[entry] = 0;
+    dic->active++;
+    return DM_OK;
+}
+
+static int dic_is_box(const dic_state *dic, const int32_t *items, size_t k) {
+    if (k >= dic->num_levels) return 0;
+    const dic_level *level = &dic->levels[k];
+    size_t e = table_find(&level->table, items);
+    return e != NOT_FOUND && (level->flags[e] & DIC_BOX);
+}
+
+static void dic_count_hit(void *ctx, const itemset_table *t, size_t entry) {
+    const dic_level *level = ctx;
+    if (!(level->flags[entry] & DIC_SOLID)) t->counts[entry]++;
+}
+
+// Starts every superset X + {i}, i a frequent item, whose k-subsets are all boxes
+static dm_status dic_extend(dic_state *dic, size_t k, size_t entry) {
+    size_t num_items = dic->levels[1].table.count;
+    int32_t *candidate = mem_alloc(dic->alloc, k + 1, sizeof(int32_t));
+    int32_t *subset = mem_alloc(dic->alloc, k, sizeof(int32_t));
+    dm_status status = candidate && subset ? DM_OK : DM_ENOMEM;
+
+    for (size_t i = 0; i < num_items && status == DM_OK; i++) {
+        if (!(dic->levels[1].flags[i] & DIC_BOX)) continue;
+        int32_t item = dic->levels[1].table.items[i];
+        const int32_t *base = table_items(&dic->levels[k].table, entry);
+
+        size_t m = 0, c = 0;
+        int duplicate = 0;
+        while (m < k && base[m] < item) candidate[c++] = base[m++];
+        if (m < k && base[m] == item) duplicate = 1;
+        candidate[c++] = item;
+        while (m < k) candidate[c++] = base[m++];
+        if (duplicate) continue;
+        if (k + 1 < dic->num_levels && table_find(&dic->levels[k + 1].table, candidate) != NOT_FOUND) continue;
+
+        int all_boxes = 1;
+        for (size_t skip = 0; skip <= k && all_boxes; skip++) {
+            for (size_t a = 0, s = 0; a <= k; a++) {
+                if (a != skip) subset[s++] = candidate[a];
+            }
+            all_boxes = dic_is_box(dic, subset, k);
+        }
+        if (all_boxes) status = dic_add(dic, candidate, k + 1);
+    }
+
+    mem_free(dic->alloc, candidate, k + 1, sizeof(int32_t));
+    mem_free(dic->alloc, subset, k, sizeof(int32_t));
+    return status;
+}
+
+// Marks boxes and solids at a checkpoint, then starts the new supersets
+static dm_status dic_checkpoint(dic_state *dic, size_t block, size_t n, uint32_t min_count) {
+    size_t num_levels = dic->num_levels;
+    dm_status status = DM_OK;
+
+    for (size_t k = 1; k < num_levels; k++) {
+        dic_level *level = &dic->levels[k];
+        for (size_t e = 0; e < level->table.count; e++) {
+            if (level->flags[e] & DIC_SOLID) continue;
+            level->seen[e] += block;
+            if (level->table.counts[e] >= min_count) level->flags[e] |= DIC_BOX;
+            if (level->seen[e] >= n) {
+                level->flags[e] |= DIC_SOLID;
+                dic->active--;
+            }
+        }
+    }
+
+    for (size_t k = 1; k < num_levels && status == DM_OK; k++) {
+        for (size_t e = 0; e < dic->levels[k].table.count && status == DM_OK; e++) {
+            uint8_t flags = dic->levels[k].flags[e];
+            if ((flags & DIC_BOX) && !(flags & DIC_EXTENDED)) {
+                dic->levels[k].flags[e] |= DIC_EXTENDED;
+                status = dic_extend(dic, k, e);
+            }
+        }
+    }
+    return status;
+}
+
+dm_status dm_dic_mine(const dm_txdb *db, size_t interval, uint32_t min_count, dm_itemsets *out) {
+    if (interval == 0) return DM_EINVAL;
+    size_t n = db->num_transactions;
+    if (n == 0) return DM_OK;
+
+    dic_state dic = { &db->alloc, NULL, 0, 0, 0 };
+    dm_status status = DM_OK;
+    for (size_t i = 0; i < db->num_items && status == DM_OK; i++) {
+        status = dic_add(&dic, &db->items[i], 1);
+    }
+
+    size_t pos = 0;
+    while (status == DM_OK && dic.active > 0) {
+        size_t end = pos + interval < n ? pos + interval : n;
+        for (size_t t = pos; t < end; t++) {
+            for (size_t k = 1; k < dic.num_levels; k++) {
+                dic_level *level = &dic.levels[k];
+                for_each_contained(&level->table, tx_items(db, t), tx_length(db, t), &level->scratch, dic_count_hit, level);
+            }
+        }
+        status = dic_checkpoint(&dic, end - pos, n, min_count);
+        pos = end == n ? 0 : end;
+    }
+
+    for (size_t k = 0; k < dic.num_levels; k++) {
+        dic_level *level = &dic.levels[k];
+        if (k > 0 && status == DM_OK) {
+            for (size_t e = 0; e < level->table.count && status == DM_OK; e++) {
+                if (level->flags[e] & DIC_BOX) {
+                    status = itemsets_append(out, table_items(&level->table, e), k, level->table.counts[e]);
+                }
+            }
+        }
+        scratch_free(&level->scratch, dic.alloc);
+        table_free(&level->table);
+        mem_free(dic.alloc, level->seen, level->meta_cap, sizeof(size_t));
+        mem_free(dic.alloc, level->flags, level->meta_cap, sizeof(uint8_t));
+    }
+    mem_free(dic.alloc, dic.levels, dic.levels_cap, sizeof(dic_level));
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Count-Min sketch
+
+#define CMS_DEPTH 4
+
+typedef struct {
+    uint32_t *counters; // CMS_DEPTH rows of width counters
+    size_t width;
+} count_min;
+
+static size_t cms_column(const count_min *cms, uint64_t hash, size_t row) {
+    uint64_t h = hash + (row + 1) * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 31;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 29;
+    return (size_t)(h % cms->width) + row * cms->width;
+}
+
+static uint32_t cms_estimate(const count_min *cms, uint64_t hash) {
+    uint32_t estimate = UINT32_MAX;
+    for (size_t row = 0; row < CMS_DEPTH; row++) {
+        uint32_t c = cms->counters[cms_column(cms, hash, row)];
+        if (c < estimate) estimate = c;
+    }
+    return estimate;
+}
+
+// Conservative update: raise each row only as far as the new estimate
+static void cms_add(count_min *cms, uint64_t hash) {
+    size_t columns[CMS_DEPTH];
+    uint32_t estimate = UINT32_MAX;
+    for (size_t row = 0; row < CMS_DEPTH; row++) {
+        columns[row] = cms_column(cms, hash, row);
+        if (cms->counters[columns[row]] < estimate) estimate = cms->counters[columns[row]];
+    }
+    if (estimate == UINT32_MAX) return;
+    for (size_t row = 0; row < CMS_DEPTH; row++) {
+        if (cms->counters[columns[row]] <= estimate) cms->counters[columns[row]] = estimate + 1;
+    }
+}
+
+dm_status dm_cms_mine(const dm_txdb *db, size_t k, uint32_t min_count, size_t sketch_bytes, dm_itemsets *out,
+                      dm_cms_stats *stats) {
+    if (k == 0) return DM_EINVAL;
+    const dm_allocator *alloc = &db->alloc;
+
+    count_min cms;
+    cms.width = sketch_bytes / (CMS_DEPTH * sizeof(uint32_t));
+    if (cms.width == 0) return DM_EINVAL;
+    cms.counters = mem_alloc(alloc, CMS_DEPTH * cms.width, sizeof(uint32_t));
+    if (!cms.counters) return DM_ENOMEM;
+    memset(cms.counters, 0, CMS_DEPTH * cms.width * sizeof(uint32_t));
+
+    // Pass 1: sketch every k-combination
+    combo_scratch scratch = { NULL, NULL, k };
+    itemset_table exact;
+    dm_status status = scratch_init(&scratch, alloc, k);
+    if (status == DM_OK) status = table_init(&exact, alloc, k);
+    if (status != DM_OK) {
+        scratch_free(&scratch, alloc);
+        mem_free(alloc, cms.counters, CMS_DEPTH * cms.width, sizeof(uint32_t));
+        return status;
+    }
+
+    for (size_t t = 0; t < db->num_transactions; t++) {
+        const int32_t *tx = tx_items(db, t);
+        size_t n = tx_length(db, t);
+        if (n < k) continue;
+        for (size_t i = 0; i < k; i++) scratch.idx[i] = i;
+        do {
+            for (size_t i = 0; i < k; i++) scratch.combo[i] = tx[scratch.idx[i]];
+            cms_add(&cms, hash_items(scratch.combo, k));
+        } while (next_combination(scratch.idx, n, k));
+    }
+
+    // Pass 2: exact counts for the combinations the sketch lets through
+    for (size_t t = 0; t < db->num_transactions && status == DM_OK; t++) {
+        const int32_t *tx = tx_items(db, t);
+        size_t n = tx_length(db, t);
+        if (n < k) continue;
+        for (size_t i = 0; i < k; i++) scratch.idx[i] = i;
+        do {
+            for (size_t i = 0; i < k; i++) scratch.combo[i] = tx[scratch.idx[i]];
+            if (cms_estimate(&cms, hash_items(scratch.combo, k)) < min_count) continue;
+            size_t entry;
+            status = table_insert(&exact, scratch.combo, &entry);
+            if (status != DM_OK) break;
+            exact.counts[entry]++;
+        } while (next_combination(scratch.idx, n, k));
+    }
+
+    if (status == DM_OK) status = append_frequent(&exact, min_count, out);
+    if (stats) {
+        stats->depth = CMS_DEPTH;
+        stats->width = cms.width;
+        stats->candidates = exact.count;
+        stats->false_positives = 0;
+        for (size_t e = 0; e < exact.count; e++) {
+            if (exact.counts[e] < min_count) stats->false_positives++;
+        }
+    }
+
+    table_free(&exact);
+    scratch_free(&scratch, alloc);
+    mem_free(alloc, cms.counters, CMS_DEPTH * cms.width, sizeof(uint32_t));
+    return status;
+}
@@ -0,0 +1,108 @@
+#ifndef DM_H
+#define DM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Frequent itemset mining library: a transaction database loaded from a file,
+// exact k-itemset hash counting, Savasere's Partition algorithm, Dynamic
+// Itemset Counting and sketch-based approximate counting. All memory goes
+// through a caller-supplied allocator.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    DM_OK = 0,
+    DM_ENOMEM = -1,
+    DM_EIO = -2,
+    DM_EINVAL = -3
+} dm_status;
+
+// Memory callbacks. free and realloc receive the size of the block being
+// released so pool and arena allocators need no headers. Passing NULL
+// wherever an allocator is accepted selects malloc/realloc/free.
+typedef struct {
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} dm_allocator;
+
+// Input line layouts accepted by dm_txdb_load
+typedef enum {
+    DM_FORMAT_ITEMS,     // "item item ..."
+    DM_FORMAT_CUST_TRANS // "custID transID n item item ..."
+} dm_format;
+
+// Transactions in CSR form: transaction t holds
+// items[offsets[t] .. offsets[t + 1]), sorted ascending without duplicates.
+typedef struct {
+    dm_allocator alloc;
+    size_t num_transactions;
+    size_t num_items;
+    size_t *offsets;
+    int32_t *items;
+    int32_t max_item;
+    size_t offsets_cap;
+    size_t items_cap;
+} dm_txdb;
+
+// A list of itemsets with their supports, also in CSR form.
+typedef struct {
+    dm_allocator alloc;
+    size_t count;
+    size_t *offsets;
+    int32_t *items;
+    uint32_t *support;
+    size_t offsets_cap;
+    size_t items_cap;
+    size_t support_cap;
+} dm_itemsets;
+
+dm_status dm_txdb_init(dm_txdb *db, const dm_allocator *alloc);
+dm_status dm_txdb_load(dm_txdb *db, const char *path, dm_format format, const dm_allocator *alloc);
+// Items need not be sorted or unique
+dm_status dm_txdb_add(dm_txdb *db, const int32_t *items, size_t n);
+void dm_txdb_free(dm_txdb *db);
+
+dm_status dm_itemsets_init(dm_itemsets *out, const dm_allocator *alloc);
+void dm_itemsets_free(dm_itemsets *out);
+
+// Counts every k-combination of every transaction in a growable hash table and
+// appends those reaching min_count to out.
+dm_status dm_hash_count(const dm_txdb *db, size_t k, uint32_t min_count, dm_itemsets *out);
+
+// Partition algorithm: each of num_partitions partitions is mined level-wise at
+// the proportional local threshold, then the union of local results, all sizes
+// together, is counted in one scan of the whole database and those reaching
+// min_count are appended to out.
+dm_status dm_partition_mine(const dm_txdb *db, size_t num_partitions, uint32_t min_count, dm_itemsets *out);
+
+// Dynamic Itemset Counting: new candidates start counting at the checkpoint,
+// every interval transactions, after all their subsets turned frequent; the
+// database is scanned cyclically until no candidate is still counting.
+dm_status dm_dic_mine(const dm_txdb *db, size_t interval, uint32_t min_count, dm_itemsets *out);
+
+// Sizing and outcome of an approximate run
+typedef struct {
+    size_t depth;          // sketch rows
+    size_t width;          // counters per row
+    size_t candidates;     // k-itemsets whose estimate reached min_count
+    size_t false_positives; // candidates below min_count once counted exactly
+} dm_cms_stats;
+
+// Approximate k-itemset counting in bounded memory. Pass 1 adds every
+// k-combination to a Count-Min sketch of at most sketch_bytes, with
+// conservative update. Pass 2 counts exactly only the combinations whose
+// estimate reaches min_count; estimates never undercount, so no frequent
+// itemset is lost. stats may be NULL.
+dm_status dm_cms_mine(const dm_txdb *db, size_t k, uint32_t min_count, size_t sketch_bytes, dm_itemsets *out,
+                      dm_cms_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef MINING_COMMON_H
+#define MINING_COMMON_H
+
+// Pieces shared by the C++ miners: the binary transaction file written by
+// cd_apriori convert, the cache size the Partition miners budget against,
+// and the TID-list mining of Partition's phase 1 with its memory estimate.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+const char BINARY_MAGIC[8] = {'D', 'M', 'T', 'X', 'D', 'B', '1', '\0'};
+
+// Binary transaction file: header, then numTransactions + 1 offsets, then the
+// sorted items of every transaction back to back (CSR layout).
+struct BinaryHeader {
+    char magic[8];
+    uint64_t numTransactions;
+    uint64_t numItems;
+    int32_t maxItem;
+    int32_t reserved;
+};
+
+// Size of the largest data cache (L3, else L2), or 0 if it cannot be detected
+inline size_t detectCacheBytes() {
+    size_t bytes = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    bytes = l3 > 0 ? l3 : (l2 > 0 ? l2 : 0);
+#endif
+    for (int index = 0; bytes == 0 && index < 8; ++index) {
+        std::ifstream in("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+        size_t size;
+        char unit = 0;
+        if (in >> size) {
+            in >> unit;
+            bytes = std::max(bytes, unit == 'M' ? size << 20 : unit == 'K' ? size << 10 : size);
+        }
+    }
+    return bytes;
+}
+
+// Expected TID-list bytes per transaction of n transactions, from a
+// histogram of item -> occurrences. Level 1 holds one TID per occurrence;
+// level 2 keeps a pair of items with counts c_i, c_j if it reaches minCount,
+// and under independence it occurs in c_i * c_j / n transactions. Levels 3 and
+// up are not modelled and can dominate on dense data, so this only sizes the
+// first split; mineTidLists() reports partitions that still do not fit.
+template <typename Histogram>
+double estimateTidBytesPerTransaction(const Histogram& histogram, size_t n, size_t minCount) {
+    if (n == 0) return 0;
+    double occurrences = 0;
+    std::vector<double> frequent;
+    for (const auto& entry : histogram) {
+        occurrences += entry.second;
+        if (entry.second >= minCount) {
+            frequent.push_back(entry.second);
+        }
+    }
+
+    double pairTids = 0;
+    for (size_t i = 0; i < frequent.size(); ++i) {
+        for (size_t j = i + 1; j < frequent.size(); ++j) {
+            double expected = frequent[i] * frequent[j] / n;
+            if (expected >= minCount) pairTids += expected;
+        }
+    }
+    return (occurrences + pairTids) * sizeof(uint32_t) / n;
+}
+
+struct TidMiningResult {
+    std::vector<std::vector<int>> itemsets;
+    size_t peakBytes; // Largest TID-list footprint held, up to where mining stopped
+    bool overBudget;  // Mining stopped because the footprint passed the limit
+};
+
+// Level-wise mining of transactions [first, last) over TID lists. Candidates
+// join two frequent itemsets sharing all but their last item; their TID list
+// is the intersection of the parents' lists. The lists of every item, and
+// later of the current and the next level, are what a partition holds; once
+// they pass limit bytes mining stops, so the caller can split the partition.
+// transactions[t] must be an iterable of sorted, unique items.
+template <typename Transactions>
+TidMiningResult mineTidLists(const Transactions& transactions, size_t first, size_t last, size_t localSupport,
+                             size_t limit) {
+    typedef std::vector<uint32_t> TidList;
+    typedef std::vector<int> Itemset;
+    TidMiningResult result{{}, 0, false};
+
+    std::map<int, TidList> itemTids;
+    for (size_t t = first; t < last; ++t) {
+        for (int item : transactions[t]) {
+            itemTids[item].push_back(t - first);
+        }
+    }
+    for (const auto& entry : itemTids) {
+        result.peakBytes += entry.second.size() * sizeof(uint32_t);
+    }
+    if (result.peakBytes > limit) {
+        result.overBudget = true;
+        return result;
+    }
+
+    std::vector<std::pair<Itemset, TidList>> level;
+    for (auto& entry : itemTids) {
+        if (entry.second.size() >= localSupport) {
+            level.push_back({{entry.first}, std::move(entry.second)});
+        }
+    }
+
+    while (!level.empty()) {
+        std::set<Itemset> frequent;
+        for (const auto& entry : level) {
+            result.itemsets.push_back(entry.first);
+            frequent.insert(entry.first);
+        }
+
+        // The current level stays alive while the next one is built
+        size_t levelBytes = 0, nextBytes = 0;
+        for (const auto& entry : level) {
+            levelBytes += entry.second.size() * sizeof(uint32_t);
+        }
+
+        std::vector<std::pair<Itemset, TidList>> next;
+        for (size_t i = 0; i < level.size(); ++i) {
+            const Itemset& a = level[i].first;
+            for (size_t j = i + 1; j < level.size(); ++j) {
+                const Itemset& b = level[j].first;
+                if (!std::equal(a.begin(), a.end() - 1, b.begin())) break;
+
+                Itemset candidate = a;
+                candidate.push_back(b.back());
+
+                // Apriori prune: every k-subset must be locally frequent
+                bool allFrequent = true;
+                for (size_t skip = 0; skip + 2 < candidate.size() && allFrequent; ++skip) {
+                    Itemset subset = candidate;
+                    subset.erase(subset.begin() + skip);
+                    allFrequent = frequent.count(subset) > 0;
+                }
+                if (!allFrequent) continue;
+
+                TidList tids;
+                std::set_intersection(level[i].second.begin(), level[i].second.end(), level[j].second.begin(),
+                                      level[j].second.end(), std::back_inserter(tids));
+                if (tids.size() >= localSupport) {
+                    nextBytes += tids.size() * sizeof(uint32_t);
+                    next.push_back({candidate, std::move(tids)});
+                    if (levelBytes + nextBytes > limit) {
+                        result.peakBytes = std::max(result.peakBytes, levelBytes + nextBytes);
+                        result.overBudget = true;
+                        return result;
+                    }
+                }
+            }
+        }
+        result.peakBytes = std::max(result.peakBytes, levelBytes + nextBytes);
+        level = std::move(next);
+    }
+
+    return result;
+}
+
+#endif
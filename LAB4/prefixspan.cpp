@@ -0,0 +1,295 @@
+#include <iostream>
+#include <vector>
+#include <set>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <ctime>
+
+using namespace std;
+
+typedef set<int> Itemset;
+
+struct Transaction {
+    int custID;
+    int transID;
+    Itemset items;
+};
+
+// Customer sequences stored flat: seqStart indexes into elemStart, which
+// indexes into items. Items inside an element are sorted ascending.
+struct SequenceDB {
+    vector<int> items;
+    vector<int> elemStart;
+    vector<int> seqStart;
+
+    int numSequences() const { return (int)seqStart.size() - 1; }
+    int firstElem(int seq) const { return seqStart[seq]; }
+    int endElem(int seq) const { return seqStart[seq + 1]; }
+};
+
+// A pseudo-projection: the postfix of sequence `seq` that starts right after
+// item position `pos` of element `elem`. Projected databases are lists of these
+// indices into the one SequenceDB, never copies of the transactions.
+struct Projection {
+    int seq;
+    int elem;
+    int pos;
+};
+
+// A sequential pattern as a list of elements (itemsets).
+typedef vector<vector<int>> Pattern;
+
+vector<Transaction> parseDataset(const string& filename) {
+    vector<Transaction> transactions;
+    ifstream file(filename);
+    string line;
+
+    while (getline(file, line)) {
+        istringstream iss(line);
+        Transaction transaction;
+        int item;
+
+        if (!(iss >> transaction.custID >> transaction.transID)) {
+            continue;
+        }
+        int numItems;
+        iss >> numItems;
+
+        while (iss >> item) {
+            transaction.items.insert(item);
+        }
+
+        transactions.push_back(transaction);
+    }
+
+    return transactions;
+}
+
+// Group transactions by custID, order each customer's transactions by transID
+// and keep only items whose sequence support reaches minSupport.
+SequenceDB buildSequenceDB(const vector<Transaction>& transactions, int minSupport) {
+    map<int, vector<const Transaction*>> byCustomer;
+    for (const Transaction& transaction : transactions) {
+        byCustomer[transaction.custID].push_back(&transaction);
+    }
+
+    map<int, int> itemSupport;
+    for (auto& entry : byCustomer) {
+        Itemset seen;
+        for (const Transaction* transaction : entry.second) {
+            seen.insert(transaction->items.begin(), transaction->items.end());
+        }
+        for (int item : seen) {
+            itemSupport[item]++;
+        }
+    }
+
+    SequenceDB db;
+    db.seqStart.push_back(0);
+    db.elemStart.push_back(0);
+    for (auto& entry : byCustomer) {
+        vector<const Transaction*>& sequence = entry.second;
+        stable_sort(sequence.begin(), sequence.end(), [](const Transaction* a, const Transaction* b) {
+            return a->transID < b->transID;
+        });
+
+        for (const Transaction* transaction : sequence) {
+            int before = db.items.size();
+            for (int item : transaction->items) {
+                if (itemSupport[item] >= minSupport) {
+                    db.items.push_back(item);
+                }
+            }
+            if ((int)db.items.size() > before) {
+                db.elemStart.push_back(db.items.size());
+            }
+        }
+
+        if ((int)db.elemStart.size() - 1 > db.seqStart.back()) {
+            db.seqStart.push_back(db.elemStart.size() - 1);
+        }
+    }
+
+    return db;
+}
+
+// Returns the position of item in element elem, or -1.
+int findInElement(const SequenceDB& db, int elem, int item) {
+    auto begin = db.items.begin() + db.elemStart[elem];
+    auto end = db.items.begin() + db.elemStart[elem + 1];
+    auto it = lower_bound(begin, end, item);
+    if (it != end && *it == item) {
+        return it - db.items.begin();
+    }
+    return -1;
+}
+
+bool elementContains(const SequenceDB& db, int elem, const vector<int>& itemset) {
+    return includes(db.items.begin() + db.elemStart[elem], db.items.begin() + db.elemStart[elem + 1],
+                    itemset.begin(), itemset.end());
+}
+
+// Count, once per sequence, the items that extend the pattern either as a new
+// element (s-extension) or into its last element (i-extension).
+void countExtensions(const SequenceDB& db, const vector<Projection>& projected, const vector<int>& lastElement,
+                     map<int, int>& sCounts, map<int, int>& iCounts) {
+    int lastItem = lastElement.empty() ? -1 : lastElement.back();
+
+    for (const Projection& p : projected) {
+        Itemset sSeen, iSeen;
+
+        // Rest of the matched element extends the last element of the pattern.
+        if (!lastElement.empty()) {
+            for (int i = p.pos + 1; i < db.elemStart[p.elem + 1]; ++i) {
+                iSeen.insert(db.items[i]);
+            }
+        }
+
+        for (int elem = p.elem + 1; elem < db.endElem(p.seq); ++elem) {
+            for (int i = db.elemStart[elem]; i < db.elemStart[elem + 1]; ++i) {
+                sSeen.insert(db.items[i]);
+            }
+            // A later element holding the whole last element also allows an i-extension.
+            if (!lastElement.empty() && elementContains(db, elem, lastElement)) {
+                for (int i = db.elemStart[elem]; i < db.elemStart[elem + 1]; ++i) {
+                    if (db.items[i] > lastItem) {
+                        iSeen.insert(db.items[i]);
+                    }
+                }
+            }
+        }
+
+        for (int item : sSeen) sCounts[item]++;
+        for (int item : iSeen) iCounts[item]++;
+    }
+}
+
+vector<Projection> projectSExtension(const SequenceDB& db, const vector<Projection>& projected, int item) {
+    vector<Projection> result;
+    for (const Projection& p : projected) {
+        for (int elem = p.elem + 1; elem < db.endElem(p.seq); ++elem) {
+            int pos = findInElement(db, elem, item);
+            if (pos >= 0) {
+                result.push_back({p.seq, elem, pos});
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+vector<Projection> projectIExtension(const SequenceDB& db, const vector<Projection>& projected,
+                                     const vector<int>& lastElement, int item) {
+    vector<Projection> result;
+    for (const Projection& p : projected) {
+        int pos = findInElement(db, p.elem, item);
+        if (pos > p.pos) {
+            result.push_back({p.seq, p.elem, pos});
+            continue;
+        }
+        for (int elem = p.elem + 1; elem < db.endElem(p.seq); ++elem) {
+            pos = findInElement(db, elem, item);
+            if (pos >= 0 && elementContains(db, elem, lastElement)) {
+                result.push_back({p.seq, elem, pos});
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+void prefixSpan(const SequenceDB& db, const Pattern& prefix, const vector<Projection>& projected, int minSupport,
+                int maxLength, int length, vector<pair<Pattern, int>>& results) {
+    if (maxLength > 0 && length >= maxLength) {
+        return;
+    }
+
+    vector<int> lastElement = prefix.empty() ? vector<int>() : prefix.back();
+    map<int, int> sCounts, iCounts;
+    countExtensions(db, projected, lastElement, sCounts, iCounts);
+
+    for (const auto& pair : iCounts) {
+        if (pair.second < minSupport) continue;
+
+        Pattern pattern = prefix;
+        pattern.back().push_back(pair.first);
+        results.push_back({pattern, pair.second});
+
+        vector<Projection> next = projectIExtension(db, projected, lastElement, pair.first);
+        prefixSpan(db, pattern, next, minSupport, maxLength, length + 1, results);
+    }
+
+    for (const auto& pair : sCounts) {
+        if (pair.second < minSupport) continue;
+
+        Pattern pattern = prefix;
+        pattern.push_back({pair.first});
+        results.push_back({pattern, pair.second});
+
+        vector<Projection> next = projectSExtension(db, projected, pair.first);
+        prefixSpan(db, pattern, next, minSupport, maxLength, length + 1, results);
+    }
+}
+
+void printPattern(const Pattern& pattern) {
+    cout << "<";
+    for (const vector<int>& element : pattern) {
+        cout << "(";
+        for (size_t i = 0; i < element.size(); ++i) {
+            if (i) cout << " ";
+            cout << element[i];
+        }
+        cout << ")";
+    }
+    cout << ">";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        cout << "Usage: " << argv[0] << " <dataset> <min_sup> [max_len]" << endl;
+        return 1;
+    }
+
+    string datasetFile = argv[1];
+    double minSupPercentage = atof(argv[2]);
+    int maxLength = argc > 3 ? atoi(argv[3]) : 0;
+
+    vector<Transaction> transactions = parseDataset(datasetFile);
+
+    set<int> customers;
+    for (const Transaction& transaction : transactions) {
+        customers.insert(transaction.custID);
+    }
+    int totalCustomers = customers.size();
+    int minSupport = max(1, (int)(minSupPercentage * totalCustomers));
+
+    // Start measuring time
+    clock_t startTime = clock();
+
+    SequenceDB db = buildSequenceDB(transactions, minSupport);
+
+    // Initial projection: every sequence, positioned before its first element.
+    vector<Projection> projected;
+    for (int seq = 0; seq < db.numSequences(); ++seq) {
+        projected.push_back({seq, db.firstElem(seq) - 1, -1});
+    }
+
+    vector<pair<Pattern, int>> results;
+    prefixSpan(db, Pattern(), projected, minSupport, maxLength, 0, results);
+
+    clock_t endTime = clock();
+
+    cout << "Customers: " << totalCustomers << ", Min Support: " << minSupport << endl;
+    for (const auto& result : results) {
+        printPattern(result.first);
+        cout << " (Sup: " << result.second << ")" << endl;
+    }
+    cout << "Frequent Sequences: " << results.size() << endl;
+
+    double timeTaken = double(endTime - startTime) / CLOCKS_PER_SEC;
+    cout << "Execution Time: " << timeTaken << " seconds" << endl;
+
+    return 0;
+}
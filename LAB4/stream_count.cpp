@@ -0,0 +1,293 @@
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// Space-Saving summary over keys of type Key. Holds at most `capacity`
+// counters; an unmonitored key evicts the minimum counter and inherits its
+// count as error. For a stream of N updates every monitored count
+// overestimates the true count by at most its error <= N / capacity, and any
+// key with true count > N / capacity is monitored.
+//
+// Counters live in a stream-summary: counters of equal count share a bucket,
+// and buckets form a list in increasing count order. An increment moves a
+// counter to the next bucket (creating it if its count is not there yet) and
+// the minimum is the first counter of the first bucket, so every update is O(1).
+template <typename Key>
+class SpaceSaving {
+public:
+    struct Counter {
+        Key key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    explicit SpaceSaving(size_t capacity) : capacity(capacity), updates(0), firstBucket(NIL), lastBucket(NIL),
+                                            freeBucket(NIL) {}
+
+    void add(Key key) {
+        ++updates;
+        auto found = slots.find(key);
+        if (found != slots.end()) {
+            increment(found->second);
+            return;
+        }
+        if (counters.size() < capacity) {
+            uint32_t slot = counters.size();
+            counters.push_back({{key, 1, 0}, NIL, NIL, NIL});
+            slots[key] = slot;
+            bool haveOnes = firstBucket != NIL && buckets[firstBucket].count == 1;
+            attach(slot, haveOnes ? firstBucket : newBucket(1, NIL));
+            return;
+        }
+        // Replace the minimum counter
+        uint32_t slot = buckets[firstBucket].head;
+        Counter& counter = counters[slot].counter;
+        slots.erase(counter.key);
+        counter.key = key;
+        counter.error = counter.count;
+        slots[key] = slot;
+        increment(slot);
+    }
+
+    uint64_t streamLength() const { return updates; }
+    uint64_t maxError() const { return capacity ? updates / capacity : updates; }
+
+    // Counters sorted by decreasing count
+    vector<Counter> top() const {
+        vector<Counter> result;
+        for (uint32_t bucket = lastBucket; bucket != NIL; bucket = buckets[bucket].prev) {
+            for (uint32_t slot = buckets[bucket].head; slot != NIL; slot = counters[slot].next) {
+                result.push_back(counters[slot].counter);
+            }
+        }
+        return result;
+    }
+
+private:
+    static const uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        Counter counter;
+        uint32_t bucket; // Bucket holding this counter's count
+        uint32_t prev;   // Neighbours in the bucket
+        uint32_t next;
+    };
+
+    struct Bucket {
+        uint64_t count;
+        uint32_t head; // First counter with this count
+        uint32_t prev; // Neighbouring buckets, by count
+        uint32_t next;
+    };
+
+    // Links a new bucket after `after`, or first when after is NIL
+    uint32_t newBucket(uint64_t count, uint32_t after) {
+        uint32_t bucket;
+        if (freeBucket != NIL) {
+            bucket = freeBucket;
+            freeBucket = buckets[bucket].next;
+        } else {
+            bucket = buckets.size();
+            buckets.push_back({});
+        }
+        uint32_t next = after == NIL ? firstBucket : buckets[after].next;
+        buckets[bucket] = {count, NIL, after, next};
+        (after == NIL ? firstBucket : buckets[after].next) = bucket;
+        (next == NIL ? lastBucket : buckets[next].prev) = bucket;
+        return bucket;
+    }
+
+    void attach(uint32_t slot, uint32_t bucket) {
+        Node& node = counters[slot];
+        node.bucket = bucket;
+        node.prev = NIL;
+        node.next = buckets[bucket].head;
+        if (node.next != NIL) counters[node.next].prev = slot;
+        buckets[bucket].head = slot;
+    }
+
+    // Unlinks a counter from its bucket, releasing the bucket once empty
+    void detach(uint32_t slot) {
+        Node& node = counters[slot];
+        Bucket& bucket = buckets[node.bucket];
+        (node.prev == NIL ? bucket.head : counters[node.prev].next) = node.next;
+        if (node.next != NIL) counters[node.next].prev = node.prev;
+        if (bucket.head != NIL) return;
+
+        (bucket.prev == NIL ? firstBucket : buckets[bucket.prev].next) = bucket.next;
+        (bucket.next == NIL ? lastBucket : buckets[bucket.next].prev) = bucket.prev;
+        bucket.next = freeBucket;
+        freeBucket = node.bucket;
+    }
+
+    void increment(uint32_t slot) {
+        uint32_t from = counters[slot].bucket;
+        uint64_t count = ++counters[slot].counter.count;
+        uint32_t next = buckets[from].next;
+        uint32_t to = (next != NIL && buckets[next].count == count) ? next : newBucket(count, from);
+        detach(slot);
+        attach(slot, to);
+    }
+
+    size_t capacity;
+    uint64_t updates;
+    vector<Node> counters;
+    vector<Bucket> buckets;
+    uint32_t firstBucket; // Smallest count
+    uint32_t lastBucket;  // Largest count
+    uint32_t freeBucket;  // Released buckets, chained through next
+    unordered_map<Key, uint32_t> slots;
+};
+
+typedef uint64_t PairKey;
+
+PairKey makePair(uint32_t a, uint32_t b) {
+    return (PairKey(a) << 32) | b;
+}
+
+// Parses one "custID transID n items..." line into a sorted, de-duplicated basket.
+bool parseBasket(const string& line, vector<uint32_t>& basket) {
+    istringstream iss(line);
+    int custID, transID, numItems;
+    if (!(iss >> custID >> transID >> numItems)) {
+        return false;
+    }
+    basket.clear();
+    int item;
+    while (iss >> item) {
+        if (item >= 0) basket.push_back(item);
+    }
+    sort(basket.begin(), basket.end());
+    basket.erase(unique(basket.begin(), basket.end()), basket.end());
+    return true;
+}
+
+// Each summary bounds error relative to its own stream; a basket of m items
+// adds m(m-1)/2 pairs, so the pair bound can reach the transaction threshold
+// even when the item bound does not.
+void warnErrorBound(const char* kind, uint64_t maxError, uint64_t updates, uint64_t threshold) {
+    if (maxError >= threshold) {
+        cerr << "Warning: " << kind << " error bound " << maxError << " reaches the min count " << threshold
+             << "; use at least " << updates / threshold + 1 << " " << kind << " counters" << endl;
+    }
+}
+
+// Writes frequent items and pairs. "guaranteed" entries are frequent
+// even after subtracting their maximum overestimate; "possible" ones
+// only reach the threshold through their upper bound.
+void writeSnapshot(ostream& out, uint64_t transactions, double minSupport, const SpaceSaving<uint32_t>& items,
+                   const SpaceSaving<PairKey>& pairs) {
+    uint64_t threshold = (uint64_t)(minSupport * transactions);
+    if (threshold == 0) threshold = 1;
+
+    out << "Snapshot after " << transactions << " transactions, min count " << threshold << endl;
+    out << "Item error bound: " << items.maxError() << ", pair error bound: " << pairs.maxError() << endl;
+    warnErrorBound("item", items.maxError(), items.streamLength(), threshold);
+    warnErrorBound("pair", pairs.maxError(), pairs.streamLength(), threshold);
+
+    out << "Frequent items:" << endl;
+    for (const auto& counter : items.top()) {
+        if (counter.count < threshold) break;
+        bool guaranteed = counter.count - counter.error >= threshold;
+        out << "{ " << counter.key << " } count <= " << counter.count << ", >= " << counter.count - counter.error
+            << (guaranteed ? " guaranteed" : " possible") << endl;
+    }
+
+    out << "Frequent pairs:" << endl;
+    for (const auto& counter : pairs.top()) {
+        if (counter.count < threshold) break;
+        bool guaranteed = counter.count - counter.error >= threshold;
+        out << "{ " << (counter.key >> 32) << " " << (uint32_t)counter.key << " } count <= " << counter.count
+            << ", >= " << counter.count - counter.error << (guaranteed ? " guaranteed" : " possible") << endl;
+    }
+}
+
+// Snapshots to a file are written aside and renamed so readers never see a partial dump.
+bool dumpSnapshot(const string& path, uint64_t transactions, double minSupport, const SpaceSaving<uint32_t>& items,
+                  const SpaceSaving<PairKey>& pairs) {
+    if (path.empty()) {
+        writeSnapshot(cout, transactions, minSupport, items, pairs);
+        return true;
+    }
+    string tmpPath = path + ".tmp";
+    {
+        ofstream out(tmpPath);
+        if (!out) return false;
+        writeSnapshot(out, transactions, minSupport, items, pairs);
+        if (!out) return false;
+    }
+    return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0]
+             << " <min_sup> [item_counters] [pair_counters] [--every N] [--snapshot file] < transactions" << endl;
+        return 1;
+    }
+
+    double minSupport = atof(argv[1]);
+    vector<string> positional;
+    uint64_t every = 0;
+    string snapshotPath;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            every = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            snapshotPath = argv[++i];
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    // By default each bound is a tenth of min_sup, as a fraction of the items
+    // (or pairs) seen rather than of the transactions. The pair stream is not
+    // known in advance, so snapshots warn when its bound reaches the min count.
+    size_t defaultCapacity = minSupport > 0 ? (size_t)(10 / minSupport) + 1 : 1000;
+    size_t itemCapacity = positional.size() > 0 ? atoi(positional[0].c_str()) : defaultCapacity;
+    size_t pairCapacity = positional.size() > 1 ? atoi(positional[1].c_str()) : 4 * defaultCapacity;
+    if (itemCapacity == 0 || pairCapacity == 0) {
+        cerr << "Counter capacities must be positive" << endl;
+        return 1;
+    }
+
+    SpaceSaving<uint32_t> items(itemCapacity);
+    SpaceSaving<PairKey> pairs(pairCapacity);
+
+    uint64_t transactions = 0;
+    string line;
+    vector<uint32_t> basket;
+    while (getline(cin, line)) {
+        if (!parseBasket(line, basket)) continue;
+        ++transactions;
+
+        for (size_t i = 0; i < basket.size(); ++i) {
+            items.add(basket[i]);
+            for (size_t j = i + 1; j < basket.size(); ++j) {
+                pairs.add(makePair(basket[i], basket[j]));
+            }
+        }
+
+        if (every && transactions % every == 0) {
+            if (!dumpSnapshot(snapshotPath, transactions, minSupport, items, pairs)) {
+                cerr << "Failed to write snapshot " << snapshotPath << endl;
+            }
+        }
+    }
+
+    if (!dumpSnapshot(snapshotPath, transactions, minSupport, items, pairs)) {
+        cerr << "Failed to write snapshot " << snapshotPath << endl;
+        return 1;
+    }
+
+    return 0;
+}
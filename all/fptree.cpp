@@ -2,94 +2,172 @@
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
+#include <cstdint>
 
 using namespace std;
 
-class FPTreeNode {
-public:
-    int item;  // Item value
-    int count; // Count of the item
-    FPTreeNode* parent; // Pointer to parent node
-    unordered_map<int, FPTreeNode*> children; // Children nodes
+const uint32_t NIL = UINT32_MAX; // No node
+
+// 24-byte node; links are 32-bit indices into the tree's node arena
+struct FPTreeNode {
+    int32_t rank;         // Item rank, 0 for the most frequent item
+    int32_t count;        // Count of the item, adjusted while mining
+    uint32_t parent;      // Parent node
+    uint32_t firstChild;  // First child node
+    uint32_t nextSibling; // Next child of the same parent
+    uint32_t link;        // Next node in the same header entry's list
+};
 
-    FPTreeNode(int item, FPTreeNode* parent = nullptr) 
-        : item(item), count(0), parent(parent) {}
+// Header table entry: an item rank, its support and its node list
+struct HeaderEntry {
+    int rank;
+    int support;
+    uint32_t head;
 };
 
+// FP-tree mined top-down (TD-FP-Growth). Header tables are processed from
+// the most frequent item down. The sub-header table of an item links the
+// ancestors of its nodes, with each ancestor's count replaced by the counts
+// of the nodes below it, so no conditional trees are built and peak memory
+// is the one tree plus a header table per recursion level. Only nodes of
+// items above the entry being mined are rewritten, and at every level those
+// entries are already done, which is what makes the in-place update safe.
 class FPTree {
 private:
-    FPTreeNode* root; // Root of the FP-tree
-    unordered_map<int, int> frequency; // Item frequency
-    unordered_map<int, FPTreeNode*> headerTable; // Header table for linking nodes
+    vector<FPTreeNode> nodes; // Node arena; freeing it releases the whole tree at once
+    uint32_t root; // Root of the FP-tree
+    vector<int> items; // Item of each rank
+    unordered_map<int, int> ranks; // Rank of each frequent item
+    vector<HeaderEntry> headerTable; // Header table by rank
+
+    uint32_t newNode(int rank, uint32_t parent) {
+        nodes.push_back({rank, 0, parent, NIL, NIL, NIL});
+        return nodes.size() - 1;
+    }
 
-    void minePatterns(FPTreeNode* node, vector<int>& prefix, vector<vector<int>>& patterns, int minSupport) {
-        if (!node) return; // Safety check
+    // Child of node holding rank, or NIL
+    uint32_t findChild(uint32_t node, int rank) const {
+        uint32_t child = nodes[node].firstChild;
+        while (child != NIL && nodes[child].rank != rank) {
+            child = nodes[child].nextSibling;
+        }
+        return child;
+    }
 
-        for (auto& pair : node->children) {
-            int item = pair.first;
-            FPTreeNode* child = pair.second;
+    void minePatterns(const vector<HeaderEntry>& header, vector<int>& prefix, vector<vector<int>>& patterns,
+                      int minSupport) {
+        for (const HeaderEntry& entry : header) {
+            // Record the pattern; its support is entry.support
+            prefix.push_back(items[entry.rank]);
+            patterns.push_back(prefix);
+
+            // Support of each higher item above this entry's nodes, clearing
+            // the ancestors' counts for the adjustment below
+            vector<int> support(entry.rank, 0);
+            for (uint32_t node = entry.head; node != NIL; node = nodes[node].link) {
+                int count = nodes[node].count;
+                for (uint32_t up = nodes[node].parent; up != root; up = nodes[up].parent) {
+                    support[nodes[up].rank] += count;
+                    nodes[up].count = 0;
+                }
+            }
 
-            // Extend the prefix path
-            vector<int> newPrefix = prefix;
-            newPrefix.push_back(item);
+            vector<HeaderEntry> subHeader;
+            vector<int> slot(entry.rank, -1);
+            for (int rank = 0; rank < entry.rank; ++rank) {
+                if (support[rank] >= minSupport) {
+                    slot[rank] = subHeader.size();
+                    subHeader.push_back({rank, support[rank], NIL});
+                }
+            }
 
-            // Record the pattern if its count meets the minimum support
-            if (child->count >= minSupport) {
-                patterns.push_back(newPrefix);
+            // Link the frequent ancestors and give them this entry's counts
+            for (uint32_t node = entry.head; node != NIL; node = nodes[node].link) {
+                int count = nodes[node].count;
+                for (uint32_t up = nodes[node].parent; up != root; up = nodes[up].parent) {
+                    int s = slot[nodes[up].rank];
+                    if (s < 0) continue;
+                    if (nodes[up].count == 0) {
+                        nodes[up].link = subHeader[s].head;
+                        subHeader[s].head = up;
+                    }
+                    nodes[up].count += count;
+                }
             }
 
-            // Recursively mine from the child
-            minePatterns(child, newPrefix, patterns, minSupport);
+            if (!subHeader.empty()) {
+                minePatterns(subHeader, prefix, patterns, minSupport);
+            }
+            prefix.pop_back();
         }
     }
 
 public:
-    FPTree() : root(new FPTreeNode(-1)) {}
-
-    void insert(const vector<int>& transaction) {
-        FPTreeNode* currentNode = root;
-
-        for (int item : transaction) {
-            frequency[item]++; // Update frequency count
-            if (currentNode->children.find(item) == currentNode->children.end()) {
-                currentNode->children[item] = new FPTreeNode(item, currentNode);
+    FPTree() : root(newNode(-1, NIL)) {}
+
+    // Insert a transaction of frequent items sorted by rank
+    void insert(const vector<int>& rankedTransaction) {
+        uint32_t currentNode = root;
+
+        for (int rank : rankedTransaction) {
+            uint32_t child = findChild(currentNode, rank);
+            if (child == NIL) {
+                child = newNode(rank, currentNode);
+                nodes[child].nextSibling = nodes[currentNode].firstChild;
+                nodes[currentNode].firstChild = child;
+                nodes[child].link = headerTable[rank].head;
+                headerTable[rank].head = child;
             }
-            currentNode = currentNode->children[item];
-            currentNode->count++;
+            currentNode = child;
+            nodes[currentNode].count++;
         }
     }
 
-    void buildHeaderTable(int minSupport) {
+    // Ranks the frequent items and inserts every transaction
+    void build(const vector<vector<int>>& transactions, int minSupport) {
+        unordered_map<int, int> frequency; // Item frequency
+        vector<int> distinct;
+        for (const auto& transaction : transactions) {
+            distinct = transaction;
+            sort(distinct.begin(), distinct.end());
+            distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+            for (int item : distinct) {
+                frequency[item]++;
+            }
+        }
+
         for (auto& pair : frequency) {
             if (pair.second >= minSupport) {
-                headerTable[pair.first] = nullptr; // Initialize header table
+                items.push_back(pair.first);
             }
         }
-    }
-
-    vector<vector<int>> mine(int minSupport) {
-        vector<vector<int>> patterns;
-        vector<int> prefix;
-
-        // Sort header table items by their frequency
-        vector<pair<int, int>> sortedItems(frequency.begin(), frequency.end());
-        sort(sortedItems.begin(), sortedItems.end(), [](const pair<int, int>& a, const pair<int, int>& b) {
-            return a.second > b.second; // Sort by frequency
+        sort(items.begin(), items.end(), [&](int a, int b) {
+            return frequency[a] != frequency[b] ? frequency[a] > frequency[b] : a < b;
         });
+        for (int rank = 0; rank < (int)items.size(); ++rank) {
+            ranks[items[rank]] = rank;
+            headerTable.push_back({rank, frequency[items[rank]], NIL});
+        }
 
-        for (auto& pair : sortedItems) {
-            int item = pair.first;
-            if (headerTable.find(item) != headerTable.end()) {
-                cout << "Mining patterns for item: " << item << endl; // Debug output
-                // Start mining from this item
-                if (root->children.find(item) != root->children.end()) {
-                    minePatterns(root->children[item], prefix, patterns, minSupport);
-                } else {
-                    cout << "Item not found in children: " << item << endl; // Debug output
-                }
+        vector<int> ranked;
+        for (const auto& transaction : transactions) {
+            ranked.clear();
+            for (int item : transaction) {
+                auto found = ranks.find(item);
+                if (found != ranks.end()) ranked.push_back(found->second);
             }
+            sort(ranked.begin(), ranked.end());
+            ranked.erase(unique(ranked.begin(), ranked.end()), ranked.end());
+            insert(ranked);
         }
+    }
 
+    // Mines every frequent pattern. Node counts and links are rewritten on
+    // the way, so a tree can be mined once.
+    vector<vector<int>> mine(int minSupport) {
+        vector<vector<int>> patterns;
+        vector<int> prefix;
+        minePatterns(headerTable, prefix, patterns, minSupport);
         return patterns;
     }
 };
@@ -98,13 +176,8 @@ public:
 vector<vector<int>> fpgrowth(const vector<vector<int>>& transactions, int minSupport) {
     FPTree tree;
 
-    // Insert transactions into the FP-tree
-    for (const auto& transaction : transactions) {
-        tree.insert(transaction);
-    }
-
-    // Build the header table
-    tree.buildHeaderTable(minSupport);
+    // Build the FP-tree and its header table
+    tree.build(transactions, minSupport);
 
     // Mine frequent patterns
     return tree.mine(minSupport);
@@ -1,28 +1,163 @@
 #include <iostream>
 #include <vector>
-#include <unordered_map>
 #include <set>
 #include <algorithm>
 #include <iterator>
-#include <functional> // For std::hash
+#include <atomic>
+#include <thread>
+#include <cstdint>
 
 using namespace std;
 
-// Custom hash function for vector<int>
-struct VectorHash {
-    size_t operator()(const vector<int>& vec) const {
-        size_t hash = 0;
-        for (int num : vec) {
-            hash ^= std::hash<int>()(num) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+// Mixes a 64-bit value (splitmix64 finalizer)
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// 64-bit fingerprint of an itemset
+inline uint64_t fingerprint(const int* items, int k, uint64_t seed) {
+    uint64_t hash = seed;
+    for (int i = 0; i < k; ++i) {
+        hash = mix64(hash ^ (uint32_t)items[i]);
+    }
+    return hash;
+}
+
+// Minimal perfect hash in the style of BBHash: each level is a bit array;
+// keys that land alone in a bit at some level own it, colliding keys retry at
+// the next level. A key's slot is the rank of its bit over all levels, so the
+// n build keys map one-to-one onto [0, n). Keys outside the build set map to
+// an arbitrary slot and must be verified by the caller.
+class MinimalPerfectHash {
+private:
+    static const int MAX_LEVELS = 32;
+    vector<uint64_t> bits;          // all levels back to back
+    vector<uint32_t> rankBefore;    // set bits in the words before each word
+    vector<size_t> levelOffset;     // first bit of each level
+    vector<size_t> levelSize;       // bits in each level
+    vector<uint64_t> fallbackKeys;  // sorted keys that never settled
+    uint32_t fallbackBase;
+
+    static size_t position(uint64_t key, int level, size_t size) {
+        uint64_t hash = mix64(key + (level + 1) * 0x9e3779b97f4a7c15ULL);
+        return (size_t)(((unsigned __int128)hash * size) >> 64);
+    }
+
+    bool testBit(size_t bit) const {
+        return (bits[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    uint32_t rank(size_t bit) const {
+        uint64_t below = bits[bit >> 6] & ((1ULL << (bit & 63)) - 1);
+        return rankBefore[bit >> 6] + __builtin_popcountll(below);
+    }
+
+public:
+    // Keys must be distinct
+    void build(vector<uint64_t> keys) {
+        bits.clear();
+        levelOffset.clear();
+        levelSize.clear();
+        fallbackKeys.clear();
+
+        for (int level = 0; level < MAX_LEVELS && !keys.empty(); ++level) {
+            size_t size = ((keys.size() * 2 + 63) / 64) * 64;
+            vector<uint64_t> seen(size / 64, 0), collided(size / 64, 0);
+            for (uint64_t key : keys) {
+                size_t pos = position(key, level, size);
+                uint64_t mask = 1ULL << (pos & 63);
+                if (seen[pos >> 6] & mask) collided[pos >> 6] |= mask;
+                seen[pos >> 6] |= mask;
+            }
+
+            vector<uint64_t> remaining;
+            for (uint64_t key : keys) {
+                size_t pos = position(key, level, size);
+                if (collided[pos >> 6] & (1ULL << (pos & 63))) {
+                    remaining.push_back(key);
+                }
+            }
+            for (size_t w = 0; w < seen.size(); ++w) {
+                seen[w] &= ~collided[w];
+            }
+
+            levelOffset.push_back(bits.size() * 64);
+            levelSize.push_back(size);
+            bits.insert(bits.end(), seen.begin(), seen.end());
+            keys.swap(remaining);
         }
-        return hash;
+
+        rankBefore.assign(bits.size(), 0);
+        uint32_t total = 0;
+        for (size_t w = 0; w < bits.size(); ++w) {
+            rankBefore[w] = total;
+            total += __builtin_popcountll(bits[w]);
+        }
+        fallbackBase = total;
+        fallbackKeys = keys;
+        sort(fallbackKeys.begin(), fallbackKeys.end());
+    }
+
+    uint32_t lookup(uint64_t key) const {
+        for (size_t level = 0; level < levelSize.size(); ++level) {
+            size_t bit = levelOffset[level] + position(key, level, levelSize[level]);
+            if (testBit(bit)) return rank(bit);
+        }
+        auto it = lower_bound(fallbackKeys.begin(), fallbackKeys.end(), key);
+        if (it != fallbackKeys.end() && *it == key) {
+            return fallbackBase + (it - fallbackKeys.begin());
+        }
+        return 0;
     }
 };
 
-// Custom equality function for vector<int>
-struct VectorEqual {
-    bool operator()(const vector<int>& lhs, const vector<int>& rhs) const {
-        return lhs == rhs;
+// The candidates of one pass, laid out by their perfect-hash slot
+class CandidateIndex {
+private:
+    int k;
+    uint64_t seed;
+    MinimalPerfectHash mph;
+    vector<int> slotItems; // k items per slot
+
+public:
+    CandidateIndex(const vector<vector<int>>& candidates, int k) : k(k), seed(0) {
+        vector<uint64_t> keys(candidates.size());
+        // Retry with another seed if two candidates share a fingerprint
+        while (true) {
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                keys[c] = fingerprint(candidates[c].data(), k, seed);
+            }
+            vector<uint64_t> sorted = keys;
+            sort(sorted.begin(), sorted.end());
+            if (adjacent_find(sorted.begin(), sorted.end()) == sorted.end()) break;
+            ++seed;
+        }
+
+        mph.build(keys);
+        slotItems.assign(candidates.size() * k, 0);
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            copy(candidates[c].begin(), candidates[c].end(), slotItems.begin() + mph.lookup(keys[c]) * k);
+        }
+    }
+
+    size_t size() const {
+        return slotItems.size() / k;
+    }
+
+    const int* items(size_t slot) const {
+        return &slotItems[slot * k];
+    }
+
+    // Slot of a k-itemset, or -1 if it is not a candidate
+    long find(const int* itemset) const {
+        if (slotItems.empty()) return -1;
+        uint32_t slot = mph.lookup(fingerprint(itemset, k, seed));
+        return equal(itemset, itemset + k, items(slot)) ? (long)slot : -1;
     }
 };
 
@@ -30,6 +165,7 @@ class HashBasedApriori {
 private:
     vector<vector<int>> transactions; // Transaction database
     int minSupport; // Minimum support threshold
+    int numThreads; // Counting threads
 
     // Function to generate candidate itemsets of size k
     set<vector<int>> generateCandidates(const set<vector<int>>& prevItemsets, int k) {
@@ -50,24 +186,84 @@ private:
         return candidates;
     }
 
-    // Function to count support of itemsets using a hash table
-    unordered_map<vector<int>, int, VectorHash, VectorEqual> countSupport(const set<vector<int>>& candidates) {
-        unordered_map<vector<int>, int, VectorHash, VectorEqual> supportCount;
+    // Count the candidates contained in transactions [begin, end). Short
+    // transactions enumerate their k-subsets and look each one up through the
+    // perfect hash; long ones test every candidate directly.
+    void countRange(const CandidateIndex& index, int k, size_t begin, size_t end, vector<atomic<int>>& counts) {
+        vector<int> subset(k), positions(k);
+        size_t numCandidates = index.size();
 
-        for (const auto& transaction : transactions) {
-            for (const auto& candidate : candidates) {
-                if (includes(transaction.begin(), transaction.end(), candidate.begin(), candidate.end())) {
-                    supportCount[candidate]++;
+        for (size_t t = begin; t < end; ++t) {
+            const vector<int>& transaction = transactions[t];
+            int n = transaction.size();
+            if (n < k) continue;
+
+            // C(n, k), stopping once it exceeds the candidate count
+            double subsets = 1;
+            for (int i = 0; i < k && subsets <= numCandidates; ++i) {
+                subsets = subsets * (n - i) / (i + 1);
+            }
+
+            if (subsets > numCandidates) {
+                for (size_t slot = 0; slot < numCandidates; ++slot) {
+                    if (includes(transaction.begin(), transaction.end(), index.items(slot), index.items(slot) + k)) {
+                        counts[slot].fetch_add(1, memory_order_relaxed);
+                    }
                 }
+                continue;
             }
+
+            for (int i = 0; i < k; ++i) positions[i] = i;
+            while (true) {
+                for (int i = 0; i < k; ++i) subset[i] = transaction[positions[i]];
+                long slot = index.find(subset.data());
+                if (slot >= 0) {
+                    counts[slot].fetch_add(1, memory_order_relaxed);
+                }
+
+                int i = k - 1;
+                while (i >= 0 && positions[i] == n - k + i) --i;
+                if (i < 0) break;
+                ++positions[i];
+                for (int j = i + 1; j < k; ++j) positions[j] = positions[j - 1] + 1;
+            }
+        }
+    }
+
+    // Function to count support of itemsets using a minimal perfect hash over
+    // the pass's fixed candidate set and one relaxed atomic counter per slot
+    vector<pair<vector<int>, int>> countSupport(const set<vector<int>>& candidates, int k) {
+        vector<vector<int>> candidateList(candidates.begin(), candidates.end());
+        CandidateIndex index(candidateList, k);
+        vector<atomic<int>> counts(index.size());
+        for (auto& count : counts) count.store(0, memory_order_relaxed);
+
+        vector<thread> workers;
+        size_t chunk = (transactions.size() + numThreads - 1) / numThreads;
+        for (int w = 0; w < numThreads; ++w) {
+            size_t begin = min(transactions.size(), w * chunk);
+            size_t end = min(transactions.size(), begin + chunk);
+            workers.emplace_back([&, begin, end]() { countRange(index, k, begin, end, counts); });
+        }
+        for (auto& worker : workers) {
+            worker.join();
         }
 
+        vector<pair<vector<int>, int>> supportCount;
+        for (size_t slot = 0; slot < index.size(); ++slot) {
+            supportCount.push_back({ vector<int>(index.items(slot), index.items(slot) + k), counts[slot].load() });
+        }
         return supportCount;
     }
 
 public:
-    HashBasedApriori(const vector<vector<int>>& trans, int minSup)
-        : transactions(trans), minSupport(minSup) {}
+    HashBasedApriori(const vector<vector<int>>& trans, int minSup, int threads = thread::hardware_concurrency())
+        : transactions(trans), minSupport(minSup), numThreads(max(1, threads)) {
+        for (auto& transaction : transactions) {
+            sort(transaction.begin(), transaction.end());
+            transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        }
+    }
 
     void run() {
         set<vector<int>> frequentItemsets;
@@ -83,7 +279,7 @@ public:
 
         // Repeat until no more frequent itemsets are found
         while (!candidates.empty()) {
-            auto supportCount = countSupport(candidates);
+            auto supportCount = countSupport(candidates, k);
             set<vector<int>> currentFrequentItemsets;
 
             for (const auto& pair : supportCount) {
@@ -1,133 +1,431 @@
+// Partition algorithm over one CSR transaction database. Partitions are
+// views into the database, never copies, and are mined concurrently on a
+// thread pool. The global count is split the same way, with one counter
+// array per task summed at the end. With partitions = 0 the partition count
+// is chosen so that the TID lists of all partitions mined at once fit a
+// memory budget, by default the detected L3 (or L2) cache size; a partition
+// whose TID lists still outgrow its share is halved until the pieces fit.
+//
+// Build: g++ -O2 -pthread parition_based.cpp -o parition_based
+// Usage: parition_based                      (built-in example)
+//        parition_based <dataset> <min_support> <partitions> [threads] [memory_budget_kb]
+// dataset is either the binary file written by LAB4/cd_apriori convert,
+// mapped as is, or a text file of one transaction per line, read through
+// TxnSource so the run appears in the io_report comparison.
+
 #include <iostream>
 #include <vector>
 #include <unordered_map>
+#include <map>
 #include <set>
 #include <algorithm>
 #include <iterator>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <queue>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include "../LAB4/mining_common.h"
+#include "../ks/KEP_Assignments/txn_source.h"
 using namespace std;
 
-// Custom hash function for vector<int>
-struct VectorHash {
-    size_t operator()(const vector<int>& vec) const {
-        size_t hash = 0;
-        for (int num : vec) {
-            hash ^= std::hash<int>()(num) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+typedef vector<int> Itemset;
+
+// The items of one transaction
+struct ItemSpan {
+    const int32_t* first;
+    const int32_t* last;
+
+    const int32_t* begin() const { return first; }
+    const int32_t* end() const { return last; }
+};
+
+// Transactions in CSR form, either mapped from a binary file or built in memory.
+class TransactionDB {
+private:
+    void* mapped = nullptr;
+    size_t mappedLength = 0;
+    vector<uint64_t> ownedOffsets;
+    vector<int32_t> ownedItems;
+    const uint64_t* offsets = nullptr;
+    const int32_t* items = nullptr;
+    size_t count = 0;
+
+public:
+    TransactionDB() {}
+    TransactionDB(const TransactionDB&) = delete;
+    TransactionDB& operator=(const TransactionDB&) = delete;
+
+    ~TransactionDB() {
+        if (mapped) munmap(mapped, mappedLength);
+    }
+
+    void build(const vector<vector<int>>& transactions) {
+        ownedOffsets.assign(1, 0);
+        ownedItems.clear();
+        for (const auto& transaction : transactions) {
+            set<int> sorted(transaction.begin(), transaction.end());
+            ownedItems.insert(ownedItems.end(), sorted.begin(), sorted.end());
+            ownedOffsets.push_back(ownedItems.size());
         }
-        return hash;
+        offsets = ownedOffsets.data();
+        items = ownedItems.data();
+        count = transactions.size();
     }
-};
 
-// Custom equality function for vector<int>
-struct VectorEqual {
-    bool operator()(const vector<int>& lhs, const vector<int>& rhs) const {
-        return lhs == rhs;
+    // Reads a text database in one pass of the source
+    void load(TxnSource& source) {
+        ownedOffsets.assign(1, 0);
+        ownedItems.clear();
+        vector<int> transaction;
+        source.rewind();
+        while (source.next(transaction)) {
+            ownedItems.insert(ownedItems.end(), transaction.begin(), transaction.end());
+            ownedOffsets.push_back(ownedItems.size());
+        }
+        offsets = ownedOffsets.data();
+        items = ownedItems.data();
+        count = ownedOffsets.size() - 1;
+    }
+
+    bool map(const string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            perror("open");
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BinaryHeader)) {
+            cerr << "Not a transaction database: " << path << endl;
+            close(fd);
+            return false;
+        }
+        mappedLength = st.st_size;
+        mapped = mmap(nullptr, mappedLength, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            perror("mmap");
+            mapped = nullptr;
+            return false;
+        }
+
+        const BinaryHeader* header = (const BinaryHeader*)mapped;
+        size_t expected = sizeof(BinaryHeader) + (header->numTransactions + 1) * sizeof(uint64_t) +
+                          header->numItems * sizeof(int32_t);
+        if (memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || expected > mappedLength) {
+            cerr << "Not a transaction database: " << path << endl;
+            return false;
+        }
+        offsets = (const uint64_t*)(header + 1);
+        items = (const int32_t*)(offsets + header->numTransactions + 1);
+        count = header->numTransactions;
+        return true;
     }
+
+    size_t size() const { return count; }
+    ItemSpan operator[](size_t t) const { return {items + offsets[t], items + offsets[t + 1]}; }
 };
 
-class Apriori {
-private:
-    vector<vector<int>> transactions; // Transaction database
-    int minSupport; // Minimum support threshold
-    int numPartitions; // Number of partitions
+// A contiguous run of transactions [first, last) of a TransactionDB
+struct TransactionSpan {
+    const TransactionDB* db;
+    size_t first;
+    size_t last;
 
-    // Function to generate candidate itemsets of size k
-    set<vector<int>> generateCandidates(const set<vector<int>>& prevItemsets, int k) {
-        set<vector<int>> candidates;
+    size_t size() const { return last - first; }
+};
 
-        for (auto it1 = prevItemsets.begin(); it1 != prevItemsets.end(); ++it1) {
-            for (auto it2 = next(it1); it2 != prevItemsets.end(); ++it2) {
-                vector<int> candidate;
-                set_union(it1->begin(), it1->end(), it2->begin(), it2->end(), back_inserter(candidate));
+// Fixed set of worker threads draining a task queue
+class ThreadPool {
+private:
+    vector<thread> workers;
+    queue<function<void()>> tasks;
+    mutex lock;
+    condition_variable ready;
+    bool stopping = false;
 
-                if (candidate.size() == k) {
-                    candidates.insert(candidate);
+public:
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 0; i < max(threads, 1u); ++i) {
+            workers.emplace_back([this] {
+                while (true) {
+                    function<void()> task;
+                    {
+                        unique_lock<mutex> guard(lock);
+                        ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) return;
+                        task = move(tasks.front());
+                        tasks.pop();
+                    }
+                    task();
                 }
+            });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    size_t size() const { return workers.size(); }
+
+    template <typename F>
+    future<typename result_of<F()>::type> submit(F f) {
+        typedef typename result_of<F()>::type Result;
+        auto task = make_shared<packaged_task<Result()>>(move(f));
+        future<Result> result = task->get_future();
+        {
+            lock_guard<mutex> guard(lock);
+            tasks.push([task] { (*task)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+};
+
+double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// A piece of the database as finally mined in phase 1
+struct MinedPartition {
+    TransactionSpan span;
+    size_t peakBytes; // largest TID-list footprint held while mining
+    vector<Itemset> itemsets;
+};
+
+class Apriori {
+private:
+    const TransactionDB& transactions; // Transaction database
+    int minSupport; // Minimum support count over the whole database
+    int numPartitions; // Number of partitions, 0 to size from memoryBudget
+    size_t memoryBudget; // Bytes shared by the partitions mined at once
+    ThreadPool& pool;
+    mutable atomic<uint64_t> scanned{0}; // Transactions visited across all in-memory passes
+    size_t longest = 0; // Size of the largest frequent itemset
+
+    double estimateBytesPerTransaction() const {
+        unordered_map<int, size_t> histogram;
+        for (size_t t = 0; t < transactions.size(); ++t) {
+            for (int item : transactions[t]) {
+                ++histogram[item];
             }
         }
+        scanned += transactions.size();
+        return estimateTidBytesPerTransaction(histogram, transactions.size(), max(minSupport, 1));
+    }
 
-        return candidates;
+    // Every pool thread mines one partition at a time, so each partition gets
+    // an equal share of the budget. There are at least as many partitions as
+    // threads.
+    int partitionsForBudget(double bytesPerTransaction) const {
+        double share = (double)memoryBudget / pool.size();
+        double partitions = ceil(bytesPerTransaction * transactions.size() / share);
+        partitions = max(partitions, (double)pool.size());
+        return (int)min(partitions, (double)transactions.size());
     }
 
-    // Function to count support of itemsets in a given partition
-    unordered_map<vector<int>, int, VectorHash, VectorEqual> countSupport(const vector<vector<int>>& partition, const set<vector<int>>& candidates) {
-        unordered_map<vector<int>, int, VectorHash, VectorEqual> supportCount;
+    // Mines a partition at its share of the global threshold. One whose TID
+    // lists pass limit bytes is halved and each half mined in turn, so every
+    // piece fits; a single transaction is mined whatever it holds. Thresholds
+    // stay proportional to piece size, which keeps the union of local results
+    // complete.
+    void minePartition(TransactionSpan partition, size_t limit, vector<MinedPartition>& pieces) const {
+        size_t n = transactions.size();
+        size_t localSupport = max<size_t>(1, ((uint64_t)minSupport * partition.size() + n - 1) / n);
+        bool splittable = partition.size() > 1;
+        TidMiningResult result = mineTidLists(transactions, partition.first, partition.last, localSupport,
+                                              splittable ? limit : SIZE_MAX);
+        scanned += partition.size();
+        if (result.overBudget) {
+            size_t middle = partition.first + partition.size() / 2;
+            minePartition({partition.db, partition.first, middle}, limit, pieces);
+            minePartition({partition.db, middle, partition.last}, limit, pieces);
+            return;
+        }
+        pieces.push_back({partition, result.peakBytes, move(result.itemsets)});
+    }
 
-        for (const auto& transaction : partition) {
-            for (const auto& candidate : candidates) {
-                // Check if candidate is included in the transaction
+    // Counts every candidate in the transactions of one span
+    vector<int> countSupport(TransactionSpan span, const vector<Itemset>& candidates) const {
+        vector<int> counts(candidates.size(), 0);
+        for (size_t t = span.first; t < span.last; ++t) {
+            ItemSpan transaction = (*span.db)[t];
+            for (size_t c = 0; c < candidates.size(); ++c) {
+                const Itemset& candidate = candidates[c];
                 if (includes(transaction.begin(), transaction.end(), candidate.begin(), candidate.end())) {
-                    supportCount[candidate]++;
+                    ++counts[c];
                 }
             }
         }
+        return counts;
+    }
 
-        return supportCount;
+    TransactionSpan slice(size_t index, size_t pieces) const {
+        size_t n = transactions.size();
+        return {&transactions, n * index / pieces, n * (index + 1) / pieces};
     }
 
 public:
-    Apriori(const vector<vector<int>>& trans, int minSup, int partitions)
-        : transactions(trans), minSupport(minSup), numPartitions(partitions) {}
+    Apriori(const TransactionDB& trans, int minSup, int partitions, size_t budget, ThreadPool& pool)
+        : transactions(trans), minSupport(minSup), numPartitions(max(partitions, 0)), memoryBudget(budget),
+          pool(pool) {
+        if (memoryBudget == 0) memoryBudget = detectCacheBytes();
+        if (memoryBudget == 0) memoryBudget = 8 << 20;
+    }
+
+    uint64_t memoryScans() const { return scanned; }
+    size_t longestItemset() const { return longest; }
 
     void run() {
-        set<vector<int>> frequentItemsets;
+        size_t n = transactions.size();
+        if (n == 0) return;
 
-        // Generate initial itemsets (single items)
-        set<vector<int>> candidates;
-        for (const auto& transaction : transactions) {
-            for (int item : transaction) {
-                candidates.insert({item});
-            }
+        // Only partitions sized from the budget are held to it; an explicit
+        // partition count is taken as given.
+        double bytesPerTransaction = estimateBytesPerTransaction();
+        size_t limit = SIZE_MAX;
+        if (numPartitions == 0) {
+            numPartitions = partitionsForBudget(bytesPerTransaction);
+            limit = memoryBudget / pool.size();
         }
 
-        // Process each partition
+        // Phase 1: mine every partition, re-splitting those that outgrow their share
+        auto start = chrono::steady_clock::now();
+        vector<future<vector<MinedPartition>>> local;
         for (int i = 0; i < numPartitions; ++i) {
-            int start = i * (transactions.size() / numPartitions);
-            int end = (i == numPartitions - 1) ? transactions.size() : (i + 1) * (transactions.size() / numPartitions);
-            vector<vector<int>> partition(transactions.begin() + start, transactions.begin() + end);
-
-            // Count support for candidates in the current partition
-            auto supportCount = countSupport(partition, candidates);
-            set<vector<int>> currentFrequentItemsets;
-
-            // Filter candidates to find frequent itemsets in the partition
-            for (const auto& pair : supportCount) {
-                if (pair.second >= minSupport) {
-                    currentFrequentItemsets.insert(pair.first);
+            TransactionSpan partition = slice(i, numPartitions);
+            local.push_back(pool.submit([this, partition, limit] {
+                vector<MinedPartition> pieces;
+                minePartition(partition, limit, pieces);
+                return pieces;
+            }));
+        }
+
+        set<Itemset> candidateSet;
+        vector<MinedPartition> partitions;
+        for (auto& result : local) {
+            for (MinedPartition& piece : result.get()) {
+                for (auto& itemset : piece.itemsets) {
+                    candidateSet.insert(move(itemset));
                 }
+                piece.itemsets.clear();
+                partitions.push_back(move(piece));
             }
+        }
+        vector<Itemset> candidates(candidateSet.begin(), candidateSet.end());
+        double phase1 = secondsSince(start);
 
-            // Merge frequent itemsets from this partition with global frequent itemsets
-            frequentItemsets.insert(currentFrequentItemsets.begin(), currentFrequentItemsets.end());
+        // Phase 2: count the candidate union over the whole database, one
+        // counter array per task
+        start = chrono::steady_clock::now();
+        size_t tasks = min(n, pool.size() * 4);
+        vector<future<vector<int>>> partial;
+        for (size_t i = 0; i < tasks; ++i) {
+            TransactionSpan span = slice(i, tasks);
+            partial.push_back(pool.submit([this, span, &candidates] { return countSupport(span, candidates); }));
         }
+        scanned += n;
+
+        vector<int> supportCount(candidates.size(), 0);
+        for (auto& result : partial) {
+            vector<int> counts = result.get();
+            for (size_t c = 0; c < counts.size(); ++c) {
+                supportCount[c] += counts[c];
+            }
+        }
+        double phase2 = secondsSince(start);
 
         // Output frequent itemsets
         cout << "Frequent Itemsets:\n";
-        for (const auto& itemset : frequentItemsets) {
+        for (size_t c = 0; c < candidates.size(); ++c) {
+            if (supportCount[c] < minSupport) continue;
+            longest = max(longest, candidates[c].size());
             cout << "{ ";
-            for (int item : itemset) {
+            for (int item : candidates[c]) {
                 cout << item << " ";
             }
-            cout << "}\n";
+            cout << "} support " << supportCount[c] << "\n";
+        }
+        cout << "Memory budget: " << memoryBudget << " bytes over " << pool.size() << " threads\n";
+        for (const MinedPartition& partition : partitions) {
+            cout << "Partition [" << partition.span.first << ", " << partition.span.last << "): estimated "
+                 << (size_t)(bytesPerTransaction * partition.span.size()) << " bytes, peak " << partition.peakBytes
+                 << " bytes\n";
         }
+        cout << "Candidates: " << candidates.size() << ", threads: " << pool.size() << ", phase 1: " << phase1
+             << " s, phase 2: " << phase2 << " s\n";
     }
 };
 
-int main() {
-    // Example transaction database
-    vector<vector<int>> transactions = {
-        {1, 2, 3},
-        {2, 3, 4},
-        {1, 2, 4},
-        {1, 2},
-        {2, 3}
-    };
-    
+bool isBinaryDatabase(const string& path) {
+    char magic[sizeof(BINARY_MAGIC)];
+    ifstream in(path, ios::binary);
+    return in.read(magic, sizeof(magic)) && memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+int main(int argc, char* argv[]) {
+    TransactionDB transactions;
+    unique_ptr<TxnSource> source; // Set for text datasets, which are I/O accounted
     int minSupport = 2; // Minimum support threshold
-    int numPartitions = 2; // Number of partitions
+    int numPartitions = 0; // Number of partitions, 0 to size from the budget
+    unsigned threads = thread::hardware_concurrency();
+    size_t memoryBudget = 0; // Bytes, 0 for the detected cache size
+
+    auto start = chrono::steady_clock::now();
+    if (argc >= 4) {
+        if (isBinaryDatabase(argv[1])) {
+            if (!transactions.map(argv[1])) return 1;
+        } else {
+            source.reset(new TxnSource(argv[1]));
+            if (!source->ok()) {
+                cerr << "Input file could not be opened: " << argv[1] << endl;
+                return 1;
+            }
+            transactions.load(*source);
+        }
+        minSupport = atoi(argv[2]);
+        numPartitions = atoi(argv[3]);
+        if (argc >= 5) threads = atoi(argv[4]);
+        if (argc >= 6) memoryBudget = (size_t)atol(argv[5]) << 10;
+    } else {
+        // Example transaction database
+        transactions.build({
+            {1, 2, 3},
+            {2, 3, 4},
+            {1, 2, 4},
+            {1, 2},
+            {2, 3}
+        });
+    }
 
-    Apriori apriori(transactions, minSupport, numPartitions);
+    ThreadPool pool(threads);
+    Apriori apriori(transactions, minSupport, numPartitions, memoryBudget, pool);
     apriori.run();
 
+    // Every pass after loading runs over the in-memory copy
+    if (source) {
+        source->noteMemoryScan(apriori.memoryScans());
+        reportIo("ParallelPartition", *source, apriori.longestItemset(), secondsSince(start));
+    }
+
     return 0;
 }
@@ -1,298 +1,420 @@
 #include<bits/stdc++.h>
-#define MOD 1000000007
-#define ll long long int
-#define s(t) scanf("%d",&t)
-#define p(t) printf("%d\n",t)
+#include "../txn_source.h"
 #define pb push_back
-#define f(t) for(int i=0;i<t;i++)
-#define fi first
-#define se second
 #define all(t) t.begin(),t.end()
-#define ci(t) cin>>t
-#define co(t) cout<<t
-#define mii map<int,int>
-#define pii pair<int,int>
 using namespace std;
 
-struct itemset {
-    vector<int> items;
+// Dynamic Itemset Counting (Brin et al.). Every itemset under consideration
+// is a node of a prefix trie; a node is a circle while its count is below
+// the threshold and a box once it reaches it, dashed while it is still
+// being counted and solid once it has seen every transaction. Transactions
+// are loaded once into a CSR array and scanned cyclically in intervals of M;
+// at each checkpoint dashed boxes spawn supersets whose subsets are all boxes.
+//
+// Usage: dic [threshold] [M] [threads]
+// With threads > 0 the file is streamed instead: a reader thread parses
+// blocks of M transactions into a ring buffer, counter threads count slices
+// of the current block into private arrays, and the main thread, as
+// coordinator, sums them and applies state changes at each checkpoint.
+
+enum state { DASHED_CIRCLE, DASHED_BOX, SOLID_CIRCLE, SOLID_BOX };
+
+struct node {
+    int item;                     // last item of the itemset, -1 for the root
+    int parent;
+    int depth;
+    state st;
     int count;
-    int start;
-    int travc;
+    int start;                    // checkpoint at which counting started
+    int remaining;                // transactions still to count
+    vector<pair<int, int>> child; // (item, node), sorted by item
 };
 
-bool ac(int x, int y) {
-    return x > y;
-}
+struct txdb {
+    vector<int> items; // transaction t is items[off[t] .. off[t + 1]), sorted
+    vector<int> off;
 
-vector<itemset> sc;
-vector<itemset> dc;
-vector<itemset> ss;
-vector<itemset> ds;
+    int size() const { return (int)off.size() - 1; }
+};
 
-int cnum(string s) {
-    int num = 0;
-    f(s.length()) {
-        num = 10 * num + (s[i] - 48);
-    }
-    return num;
+vector<node> trie;
+vector<int> active;    // dashed nodes
+vector<int> freqItems; // items whose 1-itemset is a box, ascending
+
+bool is_box(int v) {
+    return trie[v].st == DASHED_BOX || trie[v].st == SOLID_BOX;
 }
 
-vector<int> extract_items(string s) {
-    vector<int> temp;
-    int ind = -1;
-    f(s.length()) {
-        if (s[i] == ' ') {
-            ind = i;
-            break;
-        }
-    }
-    int st = ind + 1;
-    for (int i = ind + 1; i < s.length(); i++) {
-        if (s[i] == ' ') {
-            temp.pb(cnum(s.substr(st, i - st)));
-            st = i + 1;
-        }
+// One full pass over "tid item item ..." lines; the source drops the tid.
+txdb load(TxnSource& src) {
+    txdb db;
+    db.off.pb(0);
+    vector<int> txn;
+    src.rewind();
+    while (src.next(txn)) {
+        db.items.insert(db.items.end(), all(txn));
+        db.off.pb(db.items.size());
     }
-    return temp;
+    return db;
 }
 
-bool contains(vector<int> its, itemset x) {
-    bool flag = 0;
-    f(x.items.size()) {
-        int cnt = 0;
-        for (int j = 0; j < its.size(); j++) {
-            if (x.items[i] == its[j]) {
-                cnt++;
-            }
-        }
-        if (cnt == 0) {
-            flag = 1;
-            break;
-        }
+// One full pass that keeps only the transaction count and the distinct items
+int scan(TxnSource& src, set<int>& items) {
+    int n = 0;
+    vector<int> txn;
+    src.rewind();
+    while (src.next(txn)) {
+        items.insert(all(txn));
+        n++;
     }
-    return (flag == 0);
+    return n;
 }
 
-vector<vector<int>> generate_superset(itemset its) {
-    set<int> se;
-    for (int i = 1; i <= 15; i++) {
-        se.insert(i);
-    }
-    f(its.items.size()) {
-        se.erase(its.items[i]);
+int find_child(int v, int item) {
+    const vector<pair<int, int>>& c = trie[v].child;
+    auto it = lower_bound(all(c), make_pair(item, INT_MIN));
+    return (it != c.end() && it->first == item) ? it->second : -1;
+}
+
+// Node of a sorted itemset, or -1 if it is not in the trie
+int find(const vector<int>& items) {
+    int v = 0;
+    for (int x : items) {
+        v = find_child(v, x);
+        if (v < 0) return -1;
     }
-    vector<vector<int>> ans;
-    set<int>::iterator it;
-    for (it = se.begin(); it != se.end(); it++) {
-        vector<int> d = its.items;
-        d.pb(*it);
-        sort(all(d));
-        ans.pb(d);
+    return v;
+}
+
+vector<int> items_of(int v) {
+    vector<int> items;
+    for (; v > 0; v = trie[v].parent) items.pb(trie[v].item);
+    reverse(all(items));
+    return items;
+}
+
+int add_node(int parent, int item, int checkpoint, int n) {
+    node x;
+    x.item = item;
+    x.parent = parent;
+    x.depth = trie[parent].depth + 1;
+    x.st = DASHED_CIRCLE;
+    x.count = 0;
+    x.start = checkpoint;
+    x.remaining = n;
+    trie.pb(x);
+    int v = trie.size() - 1;
+    vector<pair<int, int>>& c = trie[parent].child;
+    c.insert(lower_bound(all(c), make_pair(item, INT_MIN)), make_pair(item, v));
+    active.pb(v);
+    return v;
+}
+
+// Adds one to counts[w] for every dashed itemset w of the trie below v
+// contained in the transaction suffix [p, e), walking trie children and
+// items in step. Only reads the trie.
+void count_txn(const int* p, const int* e, int v, int* counts) {
+    const vector<pair<int, int>>& c = trie[v].child;
+    size_t i = 0;
+    while (p != e && i < c.size()) {
+        if (*p < c[i].first) {
+            ++p;
+        } else if (c[i].first < *p) {
+            ++i;
+        } else {
+            int w = c[i].second;
+            if (trie[w].st == DASHED_CIRCLE || trie[w].st == DASHED_BOX) counts[w]++;
+            if (!trie[w].child.empty()) count_txn(p + 1, e, w, counts);
+            ++p;
+            ++i;
+        }
     }
-    return ans;
 }
 
-vector<vector<int>> generate_subset(vector<int> v) {
-    ll size = v.size();
-    size = 1ll << size;
-    vector<vector<int>> ans;
-    for (ll z = 1; z < size; z++) {
-        vector<int> temp;
-        for (int j = 0; j < v.size() - 1; j++) {
-            if (z & (1ll << j)) {
-                temp.pb(v[j]);
+// v just became a box: start counting v + {x} for every frequent item x
+// whose other subsets are all boxes already. A candidate is spawned by
+// whichever of its subsets turns box last, so every frequent item is tried,
+// and the new node hangs under the candidate's prefix.
+void spawn_supersets(int v, int checkpoint, int n) {
+    vector<int> items = items_of(v);
+    for (int x : freqItems) {
+        if (binary_search(all(items), x)) continue;
+        vector<int> cand = items;
+        cand.insert(upper_bound(all(cand), x), x);
+        int prefix = find(vector<int>(cand.begin(), cand.end() - 1));
+        if (prefix < 0 || !is_box(prefix) || find_child(prefix, cand.back()) >= 0) continue;
+
+        bool ok = true;
+        for (size_t skip = 0; skip < cand.size() && ok; skip++) {
+            vector<int> sub;
+            for (size_t j = 0; j < cand.size(); j++) {
+                if (j != skip) sub.pb(cand[j]);
             }
+            int u = find(sub);
+            ok = u >= 0 && is_box(u);
         }
-        ans.pb(temp);
+        if (ok) add_node(prefix, cand.back(), checkpoint, n);
     }
-    return ans;
 }
 
-bool freq(vector<int> d) {
-    int fl = 0;
-    f(ds.size()) {
-        if (ds[i].items == d) {
-            fl = 1;
-            break;
+// Streams the transaction source cyclically through a ring of blocks and counts
+// them on a fixed set of counter threads. The trie only changes between
+// count() calls, while every counter thread is idle.
+class pipeline {
+    static const int SLOTS = 4;
+
+    TxnSource& src;
+    int m;
+    vector<txdb> ring;
+    int head = 0, filled = 0;
+    size_t cursor = 0; // next transaction of ring[head]
+    bool stopping = false;
+    mutex ringMu;
+    condition_variable ringCv;
+    thread reader;
+
+    vector<vector<int>> local; // per counter thread, indexed by node
+    vector<thread> counters;
+    mutex jobMu;
+    condition_variable jobCv, doneCv;
+    const txdb* job = nullptr;
+    size_t jobBegin = 0, jobEnd = 0;
+    int generation = 0, pending = 0;
+
+    void read_loop() {
+        bool started = false;
+        vector<int> txn;
+        while (true) {
+            int slot;
+            {
+                unique_lock<mutex> lock(ringMu);
+                ringCv.wait(lock, [&] { return stopping || filled < SLOTS; });
+                if (stopping) return;
+                slot = (head + filled) % SLOTS;
+            }
+            // Only the reader touches the slot after head + filled
+            txdb& b = ring[slot];
+            b.items.clear();
+            b.off.assign(1, 0);
+            while (b.size() < m) {
+                if (!src.next(txn)) {
+                    // A block never spans the end of the file
+                    bool wrapped = started;
+                    src.rewind();
+                    started = true;
+                    if (wrapped && b.size() > 0) break;
+                    continue;
+                }
+                b.items.insert(b.items.end(), all(txn));
+                b.off.pb(b.items.size());
+            }
+            {
+                lock_guard<mutex> lock(ringMu);
+                filled++;
+            }
+            ringCv.notify_all();
         }
     }
-    f(ss.size()) {
-        if (ss[i].items == d) {
-            fl = 1;
-            break;
+
+    void count_loop(int t) {
+        int seen = 0;
+        while (true) {
+            const txdb* b;
+            size_t lo, hi;
+            {
+                unique_lock<mutex> lock(jobMu);
+                jobCv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                size_t len = jobEnd - jobBegin, T = counters.size();
+                b = job;
+                lo = jobBegin + len * t / T;
+                hi = jobBegin + len * (t + 1) / T;
+            }
+            int* counts = local[t].data();
+            for (size_t k = lo; k < hi; k++) {
+                count_txn(b->items.data() + b->off[k], b->items.data() + b->off[k + 1], 0, counts);
+            }
+            {
+                lock_guard<mutex> lock(jobMu);
+                if (--pending == 0) doneCv.notify_one();
+            }
         }
     }
-    return (fl != 0);
-}
 
-bool have(vector<int> d) {
-    int fl = 0;
-    f(ds.size()) {
-        if (ds[i].items == d) {
-            fl = 1;
-            break;
-        }
+public:
+    pipeline(TxnSource& src, int m, int threads) : src(src), m(m), ring(SLOTS), local(threads) {
+        reader = thread(&pipeline::read_loop, this);
+        for (int t = 0; t < threads; t++) counters.emplace_back(&pipeline::count_loop, this, t);
     }
-    f(ss.size()) {
-        if (ss[i].items == d) {
-            fl = 1;
-            break;
+
+    ~pipeline() {
+        {
+            lock_guard<mutex> a(ringMu), b(jobMu);
+            stopping = true;
         }
+        ringCv.notify_all();
+        jobCv.notify_all();
+        reader.join();
+        for (thread& t : counters) t.join();
     }
-    f(dc.size()) {
-        if (dc[i].items == d) {
-            fl = 1;
-            break;
+
+    // Counts the next len transactions of the cyclic stream
+    void count(int len) {
+        for (vector<int>& c : local) c.resize(trie.size(), 0);
+        while (len > 0) {
+            {
+                unique_lock<mutex> lock(ringMu);
+                ringCv.wait(lock, [&] { return filled > 0; });
+            }
+            const txdb& b = ring[head];
+            size_t take = min((size_t)len, b.size() - cursor);
+            {
+                lock_guard<mutex> lock(jobMu);
+                job = &b;
+                jobBegin = cursor;
+                jobEnd = cursor + take;
+                pending = counters.size();
+                generation++;
+            }
+            jobCv.notify_all();
+            {
+                unique_lock<mutex> lock(jobMu);
+                doneCv.wait(lock, [&] { return pending == 0; });
+            }
+            cursor += take;
+            len -= take;
+            if (cursor == (size_t)b.size()) {
+                cursor = 0;
+                {
+                    lock_guard<mutex> lock(ringMu);
+                    head = (head + 1) % SLOTS;
+                    filled--;
+                }
+                ringCv.notify_all();
+            }
         }
     }
-    f(sc.size()) {
-        if (sc[i].items == d) {
-            fl = 1;
-            break;
+
+    // Moves the private counts of v into the trie
+    void collect(int v) {
+        for (vector<int>& c : local) {
+            trie[v].count += c[v];
+            c[v] = 0;
         }
     }
-    return (fl != 0);
-}
+};
 
-int main() {
-    ifstream in;
-    in.open("transaction.txt");
-    ofstream out;
-    out.open("dic_apriori.txt");
-    
-    string s;
-    int ctxn = 0;
-    set<int> its1;
-    int thres = 8;
+int main(int argc, char* argv[]) {
+    int thres = argc > 1 ? atoi(argv[1]) : 8;
+    int m = argc > 2 ? max(1, atoi(argv[2])) : 13;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
 
-    while (getline(in, s)) {
-        vector<int> txn = extract_items(s);
-        f(txn.size()) {
-            its1.insert(txn[i]);
-        }
-        ctxn++;
+    TxnSource src("transaction.txt", 1);
+    if (!src.ok()) {
+        cerr << "Input file could not be opened\n";
+        return 1;
     }
+    auto startTime = chrono::steady_clock::now();
 
-    set<int>::iterator it;
-    for (it = its1.begin(); it != its1.end(); it++) {
-        itemset temp;
-        temp.items.pb(*it);
-        temp.count = 0;
-        temp.start = 0;
-        temp.travc = 0;
-        dc.pb(temp);
+    // Both modes need n and the item universe up front; the streaming mode
+    // gets them from a counting pass that keeps no transactions.
+    txdb db;
+    set<int> its1;
+    int n;
+    if (threads > 0) {
+        n = scan(src, its1);
+    } else {
+        db = load(src);
+        n = db.size();
+        its1.insert(all(db.items));
     }
+    unique_ptr<pipeline> pipe;
+    vector<int> counts;
+    if (threads > 0 && n > 0) pipe.reset(new pipeline(src, m, threads));
 
-    int m = 13;
-    int r = 0;
-    int cpart = ctxn / m;
-    itemset nul;
-    nul.count = ctxn;
-    nul.start = 0;
-    ss.pb(nul);
-    
-    int e = 1;
-    in.close();
-    
-    while (dc.size() > 0 || ds.size() > 0) {
-        in.open("transaction.txt");
-        int lno = 0;
-        while (getline(in, s)) {
-            vector<int> its = extract_items(s);
-            
-            f(dc.size()) {
-                if (contains(its, dc[i])) {
-                    dc[i].count++;
-                }
-            }
-            f(ds.size()) {
-                if (contains(its, ds[i])) {
-                    ds[i].count++;
-                }
-            }
-            lno++;
-            
-            if (lno % m == 0) {
-                vector<int> pos;
-                
-                f(dc.size()) {
-                    if (dc[i].count >= thres) {
-                        pos.pb(i);
-                        ds.pb(dc[i]);
-                        
-                        vector<vector<int>> superset = generate_superset(dc[i]);
-                        for (int j = 0; j < superset.size(); j++) {
-                            if (!have(superset[j])) {
-                                vector<vector<int>> subset = generate_subset(superset[j]);
-                                int flag = 0;
-                                for (int k = 0; k < subset.size(); k++) {
-                                    if (!freq(subset[k])) {
-                                        flag = 1;
-                                        break;
-                                    }
-                                }
-                                if (flag == 0) {
-                                    itemset temp;
-                                    temp.count = 0;
-                                    temp.start = lno / m;
-                                    temp.items = superset[j];
-                                    temp.travc = e;
-                                    dc.pb(temp);
-                                }
-                            }
-                        }
-                    }
-                }
-
-                int eh = 0;
-                f(pos.size()) {
-                    dc.erase(dc.begin() + pos[i] - eh);
-                    eh++;
-                }
-                
-                vector<int> fill;
-                f(dc.size()) {
-                    if ((dc[i].start == ((lno / m) - 1 + m) % m && dc[i].travc == e - 1) || (dc[i].travc <= e - 2)) {
-                        fill.pb(i);
-                        sc.pb(dc[i]);
-                    }
-                }
+    node root;
+    root.item = -1;
+    root.parent = -1;
+    root.depth = 0;
+    root.st = SOLID_BOX;
+    root.count = n;
+    root.start = 0;
+    root.remaining = 0;
+    trie.pb(root);
 
-                eh = 0;
-                f(fill.size()) {
-                    dc.erase(dc.begin() + fill[i] - eh);
-                    eh++;
-                }
+    for (int x : its1) add_node(0, x, 0, n);
 
-                fill.clear();
-                f(ds.size()) {
-                    if ((ds[i].start == ((lno / m) - 1 + m) % m && ds[i].travc == e - 1) || (ds[i].travc <= e - 2)) {
-                        fill.pb(i);
-                        ss.pb(ds[i]);
-                    }
-                }
+    // Cyclic scan: each interval ends at the next checkpoint or when the
+    // oldest dashed itemset has seen every transaction, whichever is first.
+    int pos = 0, checkpoint = 0;
+    while (!active.empty() && n > 0) {
+        int len = m;
+        for (int v : active) len = min(len, trie[v].remaining);
+        if (pipe) {
+            pipe->count(len);
+        } else {
+            counts.resize(trie.size(), 0);
+            for (int k = 0; k < len; k++) {
+                count_txn(db.items.data() + db.off[pos], db.items.data() + db.off[pos + 1], 0, counts.data());
+                pos = (pos + 1) % n;
+            }
+            src.noteMemoryScan(len);
+        }
+        checkpoint++;
 
-                eh = 0;
-                f(fill.size()) {
-                    ds.erase(ds.begin() + fill[i] - eh);
-                    eh++;
-                }
+        vector<int> boxed, still;
+        for (int v : active) {
+            if (pipe) {
+                pipe->collect(v);
+            } else {
+                trie[v].count += counts[v];
+                counts[v] = 0;
+            }
+            trie[v].remaining -= len;
+            if (trie[v].st == DASHED_CIRCLE && trie[v].count >= thres) {
+                trie[v].st = DASHED_BOX;
+                boxed.pb(v);
+            }
+            if (trie[v].remaining == 0) {
+                trie[v].st = trie[v].st == DASHED_BOX ? SOLID_BOX : SOLID_CIRCLE;
+            } else {
+                still.pb(v);
             }
         }
-        e++;
-        in.close();
+        active = still;
+
+        for (int v : boxed) {
+            if (trie[v].depth == 1) freqItems.insert(upper_bound(all(freqItems), trie[v].item), trie[v].item);
+        }
+        for (int v : boxed) spawn_supersets(v, checkpoint, n);
     }
 
+    pipe.reset();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    int longest = 0;
+    for (const node& x : trie) {
+        if (x.st == SOLID_BOX) longest = max(longest, x.depth);
+    }
+    reportIo(threads > 0 ? "DIC-pipelined" : "DIC", src, longest, seconds);
+
+    ofstream out("dic_apriori.txt");
     out << "Frequent itemsets are-\n";
-    f(ss.size()) {
-        for (int j = 0; j < ss[i].items.size(); j++) {
-            out << ss[i].items[j] << " ";
+    // Depth-first over the trie lists boxes in lexicographic order
+    vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        int v = stack.back();
+        stack.pop_back();
+        if (v > 0 && trie[v].st == SOLID_BOX) {
+            for (int x : items_of(v)) out << x << " ";
+            out << "(" << trie[v].count << ")" << endl;
+        }
+        if (!is_box(v)) continue;
+        for (auto it = trie[v].child.rbegin(); it != trie[v].child.rend(); ++it) {
+            stack.pb(it->second);
         }
-        out << endl;
     }
 
     out.close();
     return 0;
 }
-
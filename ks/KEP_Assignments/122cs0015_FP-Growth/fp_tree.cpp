@@ -7,216 +7,1111 @@
 #include <algorithm>
 #include <sstream>
 #include <memory>
+#include <cstdint>
+#include <cctype>
+#include <deque>
+#include <numeric>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
-// Node structure for the FP-Tree
+const uint32_t NIL = UINT32_MAX;
+
+// 0: results only, 1: progress, 2: also every transaction, item frequency
+// and conditional pattern base
+int verbosity = 0;
+
+// Node structure for the FP-Tree: 32-bit indices into a NodeArena, children
+// kept as a first-child/next-sibling list, nodeLink chaining the nodes of the
+// same item from its header entry
 struct FPTreeNode {
+    int32_t item;
+    int32_t count;
+    uint32_t parent;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+    uint32_t nodeLink;
+};
+static_assert(sizeof(FPTreeNode) == 24, "FPTreeNode should stay 24 bytes");
+
+// Bump allocator shared by a tree and all its conditional trees. Trees are
+// built and destroyed in LIFO order during mining, so freeing a conditional
+// tree is a single release() back to the mark taken when it was built.
+// An arena can instead be attached to the read-only nodes of a saved tree.
+class NodeArena {
+private:
+    vector<FPTreeNode> nodes;
+    const FPTreeNode* mapped = nullptr;
+
+public:
+    // Grows geometrically; a tree is far smaller than its item occurrences
+    // once prefixes are shared, so nothing is reserved up front
+    uint32_t allocate(int item, uint32_t parent, int count) {
+        if (nodes.size() >= NIL) {
+            // NIL is the null link, so indices stop one short of it
+            cerr << "FP-tree exceeds " << NIL << " nodes" << endl;
+            exit(1);
+        }
+        nodes.push_back({item, count, parent, NIL, NIL, NIL});
+        return nodes.size() - 1;
+    }
+
+    uint32_t mark() const { return nodes.size(); }
+    void release(uint32_t mark) { nodes.resize(mark); }
+
+    void attach(const FPTreeNode* saved) { mapped = saved; }
+    const FPTreeNode* data() const { return nodes.data(); }
+
+    FPTreeNode& operator[](uint32_t index) { return nodes[index]; }
+    const FPTreeNode& operator[](uint32_t index) const { return mapped ? mapped[index] : nodes[index]; }
+};
+
+// Work-stealing scheduler. Each worker pushes and pops tasks at the back of
+// its own deque and, when that is empty, steals from the front of another's,
+// so stolen tasks are the oldest and usually the largest. run() returns once
+// every task, including those spawned while running, has finished.
+class TaskScheduler {
+public:
+    typedef function<void(int worker)> Task;
+
+    explicit TaskScheduler(int threads) : queues(threads), pending(0), nextQueue(0) {
+        for (auto& queue : queues) queue.reset(new Queue);
+    }
+
+    int size() const { return queues.size(); }
+
+    // Queues a task on the given worker, or round-robin when worker is -1
+    void spawn(int worker, Task task) {
+        if (worker < 0) worker = nextQueue++ % queues.size();
+        pending++;
+        lock_guard<mutex> guard(queues[worker]->lock);
+        queues[worker]->tasks.push_back(move(task));
+    }
+
+    // Runs queued tasks on size() threads, the caller being worker 0
+    void run() {
+        vector<thread> threads;
+        for (int worker = 1; worker < size(); ++worker) {
+            threads.emplace_back(&TaskScheduler::work, this, worker);
+        }
+        work(0);
+        for (auto& t : threads) t.join();
+    }
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+    vector<unique_ptr<Queue>> queues;
+    atomic<long> pending; // queued or running tasks
+    size_t nextQueue;
+
+    bool pop(int worker, Task& task) {
+        Queue& queue = *queues[worker];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) return false;
+        task = move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int worker, Task& task) {
+        for (int i = 1; i < size(); ++i) {
+            Queue& queue = *queues[(worker + i) % size()];
+            lock_guard<mutex> guard(queue.lock);
+            if (queue.tasks.empty()) continue;
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void work(int worker) {
+        while (pending > 0) {
+            Task task;
+            if (pop(worker, task) || steal(worker, task)) {
+                task(worker);
+                pending--;
+            } else {
+                this_thread::yield();
+            }
+        }
+    }
+};
+
+// A transaction or prefix path together with the number of times it occurs
+typedef vector<pair<vector<int>, int>> WeightedTransactions;
+
+// Header table entry: a frequent item, its support and its first node
+struct HeaderEntry {
     int item;
-    int count;
-    unordered_map<int, FPTreeNode*> children;
-    FPTreeNode* parent;
+    int support;
+    uint32_t head;
+};
+
+// Layout of a saved tree: this header, headerCount HeaderEntry records, then
+// nodeCount nodes, all in native byte order
+struct TreeFileHeader {
+    char magic[8];
+    uint32_t minSupportCount; // support the tree was built at
+    uint32_t headerCount;
+    uint32_t nodeCount;
+    uint32_t root;
+};
+const char TREE_MAGIC[8] = "FPTREE1";
+
+class FPGrowthMiner;
+
+// Read-only mapping of a whole input file
+struct MappedInput {
+    const char* data = nullptr;
+    size_t length = 0;
+
+    explicit MappedInput(const string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            cerr << "Input file could not be opened\n";
+            exit(1);
+        }
+        length = st.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                cerr << "Input file could not be mapped\n";
+                exit(1);
+            }
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            data = (const char*)mapped;
+        }
+        close(fd);
+    }
+
+    ~MappedInput() {
+        if (data) munmap((void*)data, length);
+    }
 
-    FPTreeNode(int item, FPTreeNode* parent = nullptr) : item(item), count(1), parent(parent) {}
+    MappedInput(const MappedInput&) = delete;
+    MappedInput& operator=(const MappedInput&) = delete;
 };
 
+// Calls visit(items) for every non-empty line in [begin, end) of a mapped
+// file, items de-duplicated. Items are separated by whitespace or commas;
+// a token that is not an int is skipped. Returns the number skipped.
+template <typename Visitor>
+size_t forEachTransaction(const char* data, size_t begin, size_t end, Visitor visit) {
+    vector<int> transaction;
+    size_t rejected = 0;
+    size_t pos = begin;
+    while (pos < end) {
+        const char* nl = (const char*)memchr(data + pos, '\n', end - pos);
+        size_t lineEnd = nl ? nl - data : end;
+        transaction.clear();
+        size_t i = pos;
+        while (i < lineEnd) {
+            if (isspace((unsigned char)data[i]) || data[i] == ',') {
+                ++i;
+                continue;
+            }
+            size_t tokenEnd = i;
+            while (tokenEnd < lineEnd && !isspace((unsigned char)data[tokenEnd]) && data[tokenEnd] != ',') {
+                ++tokenEnd;
+            }
+            bool negative = data[i] == '-';
+            size_t digits = i + negative;
+            long long value = 0;
+            bool valid = digits < tokenEnd;
+            for (size_t j = digits; j < tokenEnd && valid; ++j) {
+                valid = data[j] >= '0' && data[j] <= '9' && value <= INT32_MAX;
+                value = value * 10 + (data[j] - '0');
+            }
+            valid = valid && (negative ? -value >= INT32_MIN : value <= INT32_MAX);
+            if (valid) {
+                transaction.push_back(negative ? -value : value);
+            } else {
+                ++rejected;
+            }
+            i = tokenEnd;
+        }
+        pos = lineEnd + 1;
+        if (transaction.empty()) continue;
+        sort(transaction.begin(), transaction.end());
+        transaction.erase(unique(transaction.begin(), transaction.end()), transaction.end());
+        visit(transaction);
+    }
+    return rejected;
+}
+
+void warnRejected(size_t rejected) {
+    if (rejected > 0) cerr << "Skipped " << rejected << " tokens that are not integers\n";
+}
+
 // Class for FP-Tree Algorithm
 class FPTree {
 private:
-    FPTreeNode* root;
-    unordered_map<int, vector<FPTreeNode*>> headerTable;
-    vector<vector<int>> transactions;
+    unique_ptr<NodeArena> ownedArena; // set on the main tree only
+    NodeArena* arena;
+    uint32_t base; // arena mark before this tree's first node
+    uint32_t root;
+    vector<HeaderEntry> headerTable; // by decreasing support, ties by item
+    unordered_map<int, uint32_t> headerIndex; // item -> header entry
     int minSupportCount;
+    ostream* log; // debug output
+    void* mapping = nullptr; // saved tree file, when loaded
+    size_t mappingLength = 0;
 
-    // Parse input file
-    void parseInputFile(const string& filename) {
-        ifstream fin(filename);
-        if (!fin) {
-            cerr << "Input file could not be opened\n";
-            exit(1);
+    // Build the main FP-Tree in two passes over the mapped input file: a
+    // parallel item histogram over line-aligned chunks, then a single pass
+    // inserting each transaction as soon as it is filtered and sorted, so
+    // transactions are never held in memory
+    void buildFromFile(const string& filename, int threads) {
+        MappedInput input(filename);
+        const char* data = input.data;
+        size_t length = input.length;
+
+        // Pass 1: per-chunk histograms, merged
+        vector<size_t> bounds = {0};
+        for (int chunk = 1; chunk < threads; ++chunk) {
+            size_t pos = max(bounds.back(), length * chunk / threads);
+            const char* nl = pos < length ? (const char*)memchr(data + pos, '\n', length - pos) : nullptr;
+            bounds.push_back(nl ? nl - data + 1 : length);
+        }
+        bounds.push_back(length);
+        vector<unordered_map<int, int>> histograms(threads);
+        vector<size_t> rejected(threads);
+        TaskScheduler scheduler(threads);
+        for (int chunk = 0; chunk < threads; ++chunk) {
+            scheduler.spawn(-1, [&, chunk](int) {
+                unordered_map<int, int>& histogram = histograms[chunk];
+                rejected[chunk] = forEachTransaction(data, bounds[chunk], bounds[chunk + 1],
+                                                     [&](const vector<int>& transaction) {
+                                                         for (int item : transaction) {
+                                                             histogram[item]++;
+                                                         }
+                                                     });
+            });
+        }
+        scheduler.run();
+        warnRejected(accumulate(rejected.begin(), rejected.end(), (size_t)0));
+        unordered_map<int, int> itemFrequency = move(histograms[0]);
+        for (int chunk = 1; chunk < threads; ++chunk) {
+            for (const auto& pair : histograms[chunk]) {
+                itemFrequency[pair.first] += pair.second;
+            }
+            unordered_map<int, int>().swap(histograms[chunk]);
         }
+        printFrequencies(itemFrequency);
+        buildHeader(itemFrequency);
 
-        string str;
-        while (getline(fin, str)) {
-            vector<int> transaction;
-            stringstream ss(str);
-            int num;
-            while (ss >> num) {
-                transaction.push_back(num);
+        // Pass 2: filter, sort and insert each transaction as it is read
+        size_t transactions = 0;
+        if (verbosity >= 2) *log << "Parsed Transactions:" << endl;
+        forEachTransaction(data, 0, length, [&](vector<int>& transaction) {
+            ++transactions;
+            if (verbosity >= 2) {
+                for (int item : transaction) {
+                    *log << item << " ";
+                }
+                *log << endl;
             }
-            transactions.push_back(transaction);
+            filterAndSort(transaction);
+            if (!transaction.empty()) insertTransaction(transaction, 1);
+        });
+
+        if (verbosity >= 1) {
+            *log << "FP-Tree Built: " << transactions << " transactions, " << headerTable.size()
+                 << " frequent items, " << arena->mark() - base << " nodes" << endl;
         }
-        fin.close();
+    }
 
-        // Debug: Print transactions
-        cout << "Parsed Transactions:" << endl;
-        for (const auto& transaction : transactions) {
-            for (int item : transaction) {
-                cout << item << " ";
+    void printFrequencies(const unordered_map<int, int>& itemFrequency) const {
+        if (verbosity < 2) return;
+        *log << "Item Frequencies:" << endl;
+        for (const auto& pair : itemFrequency) {
+            *log << "Item: " << pair.first << " Count: " << pair.second << endl;
+        }
+    }
+
+    // Header table of the items reaching minSupportCount, by decreasing
+    // support with ties by item, the order transactions are inserted in
+    void buildHeader(const unordered_map<int, int>& itemFrequency) {
+        for (const auto& pair : itemFrequency) {
+            if (pair.second >= minSupportCount) {
+                headerTable.push_back({pair.first, pair.second, NIL});
             }
-            cout << endl;
+        }
+        sort(headerTable.begin(), headerTable.end(), [](const HeaderEntry& a, const HeaderEntry& b) {
+            return a.support != b.support ? a.support > b.support : a.item < b.item;
+        });
+        for (uint32_t i = 0; i < headerTable.size(); ++i) {
+            headerIndex[headerTable[i].item] = i;
         }
     }
 
-    // Insert a transaction into the FP-Tree
-    void insertTransaction(const vector<int>& transaction) {
-        FPTreeNode* currentNode = root;
+    // Keeps the header items of a transaction, in header order
+    void filterAndSort(vector<int>& transaction) const {
+        size_t kept = 0;
         for (int item : transaction) {
-            if (currentNode->children.find(item) == currentNode->children.end()) {
-                FPTreeNode* newNode = new FPTreeNode(item, currentNode);
-                currentNode->children[item] = newNode;
-                headerTable[item].push_back(newNode);
+            auto found = headerIndex.find(item);
+            if (found != headerIndex.end()) transaction[kept++] = found->second;
+        }
+        transaction.resize(kept);
+        sort(transaction.begin(), transaction.end());
+        for (int& entry : transaction) {
+            entry = headerTable[entry].item;
+        }
+    }
+
+    // Insert a transaction occurring count times into the FP-Tree
+    void insertTransaction(const vector<int>& transaction, int count) {
+        NodeArena& nodes = *arena;
+        uint32_t currentNode = root;
+        for (int item : transaction) {
+            uint32_t child = nodes[currentNode].firstChild;
+            while (child != NIL && nodes[child].item != item) {
+                child = nodes[child].nextSibling;
+            }
+            if (child == NIL) {
+                child = nodes.allocate(item, currentNode, count);
+                nodes[child].nextSibling = nodes[currentNode].firstChild;
+                nodes[currentNode].firstChild = child;
+                HeaderEntry& entry = headerTable[headerIndex[item]];
+                nodes[child].nodeLink = entry.head;
+                entry.head = child;
             } else {
-                currentNode->children[item]->count++;
+                nodes[child].count += count;
             }
-            currentNode = currentNode->children[item];
+            currentNode = child;
         }
     }
 
-    // Build the FP-Tree
-    void buildTree() {
+    // Build a conditional FP-Tree for mining
+    void buildConditionalTree(const WeightedTransactions& conditionalPatternBase) {
+        root = arena->allocate(-1, NIL, 0);
+
+        // Count frequency of each item, weighted by how often its path occurs
         unordered_map<int, int> itemFrequency;
-        // Count frequency of each item
-        for (const auto& transaction : transactions) {
-            for (int item : transaction) {
-                itemFrequency[item]++;
+        for (const auto& path : conditionalPatternBase) {
+            for (int item : path.first) {
+                itemFrequency[item] += path.second;
             }
         }
+        printFrequencies(itemFrequency);
+        buildHeader(itemFrequency);
 
-        // Debug: Print item frequencies
-        cout << "Item Frequencies:" << endl;
-        for (const auto& pair : itemFrequency) {
-            cout << "Item: " << pair.first << " Count: " << pair.second << endl;
+        vector<int> filtered;
+        for (const auto& path : conditionalPatternBase) {
+            filtered = path.first;
+            filterAndSort(filtered);
+            if (!filtered.empty()) insertTransaction(filtered, path.second);
         }
 
-        // Remove items that don't meet the minimum support count
-        vector<vector<int>> filteredTransactions;
-        for (auto& transaction : transactions) {
-            vector<int> filtered;
-            for (int item : transaction) {
-                if (itemFrequency[item] >= minSupportCount) {
-                    filtered.push_back(item);
-                }
-            }
-            if (!filtered.empty()) {
-                sort(filtered.begin(), filtered.end(), [&](int a, int b) {
-                    return itemFrequency[a] > itemFrequency[b]; // Sort by frequency
-                });
-                filteredTransactions.push_back(filtered);
-            }
+        if (verbosity >= 2) *log << "FP-Tree Built" << endl;
+    }
+
+    // Empty main tree, filled in by load()
+    FPTree() : ownedArena(new NodeArena), arena(ownedArena.get()), base(0), minSupportCount(0), log(&cout) {}
+
+public:
+    // Constructor for main FP-Tree; pass 1 runs on threads threads
+    FPTree(const string& filename, int minSupportCount, int threads = 1)
+        : ownedArena(new NodeArena), arena(ownedArena.get()), base(0), minSupportCount(minSupportCount), log(&cout) {
+        root = arena->allocate(-1, NIL, 0);
+        buildFromFile(filename, max(threads, 1));
+    }
+
+    // Constructor for conditional FP-Tree, built on top of the given arena
+    FPTree(NodeArena& parentArena, const WeightedTransactions& conditionalPatternBase, int minSupportCount,
+           ostream& log)
+        : arena(&parentArena), base(parentArena.mark()), minSupportCount(minSupportCount), log(&log) {
+        buildConditionalTree(conditionalPatternBase);
+    }
+
+    // Frees every node of this tree at once
+    ~FPTree() {
+        arena->release(base);
+        if (mapping) munmap(mapping, mappingLength);
+    }
+
+    FPTree(const FPTree&) = delete;
+    FPTree& operator=(const FPTree&) = delete;
+
+    // Writes the main tree to path; the file is written aside and renamed
+    bool save(const string& path) const {
+        TreeFileHeader fileHeader;
+        memcpy(fileHeader.magic, TREE_MAGIC, sizeof(TREE_MAGIC));
+        fileHeader.minSupportCount = minSupportCount;
+        fileHeader.headerCount = headerTable.size();
+        fileHeader.nodeCount = arena->mark();
+        fileHeader.root = root;
+
+        string tmpPath = path + ".tmp";
+        {
+            ofstream out(tmpPath, ios::binary);
+            if (!out) return false;
+            out.write((const char*)&fileHeader, sizeof(fileHeader));
+            out.write((const char*)headerTable.data(), headerTable.size() * sizeof(HeaderEntry));
+            out.write((const char*)arena->data(), fileHeader.nodeCount * sizeof(FPTreeNode));
+            if (!out) return false;
         }
-        transactions = move(filteredTransactions);
+        return rename(tmpPath.c_str(), path.c_str()) == 0;
+    }
 
-        // Insert filtered transactions into the FP-Tree
-        for (const auto& transaction : transactions) {
-            insertTransaction(transaction);
+    // Maps a tree written by save() for mining at minSupportCount, which may
+    // not be below the support it was built at. Nodes are used in place, so
+    // loading costs only the mmap and a copy of the header table.
+    static unique_ptr<FPTree> load(const string& path, int minSupportCount) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            cerr << "Tree file could not be opened\n";
+            return nullptr;
+        }
+        struct stat st;
+        void* mapped = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TreeFileHeader)) {
+            mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            cerr << "Tree file could not be mapped\n";
+            return nullptr;
         }
 
-        // Debug: Print tree structure
-        cout << "FP-Tree Built" << endl;
+        const TreeFileHeader* fileHeader = (const TreeFileHeader*)mapped;
+        size_t expected = sizeof(TreeFileHeader) + (size_t)fileHeader->headerCount * sizeof(HeaderEntry) +
+                          (size_t)fileHeader->nodeCount * sizeof(FPTreeNode);
+        if (memcmp(fileHeader->magic, TREE_MAGIC, sizeof(TREE_MAGIC)) != 0 || (size_t)st.st_size != expected ||
+            fileHeader->root >= fileHeader->nodeCount) {
+            cerr << "Not a saved FP-Tree: " << path << "\n";
+            munmap(mapped, st.st_size);
+            return nullptr;
+        }
+        if (minSupportCount < (int)fileHeader->minSupportCount) {
+            cerr << "Tree was built at support " << fileHeader->minSupportCount << ", cannot mine at "
+                 << minSupportCount << "\n";
+            munmap(mapped, st.st_size);
+            return nullptr;
+        }
+
+        unique_ptr<FPTree> tree(new FPTree());
+        tree->minSupportCount = minSupportCount;
+        tree->mapping = mapped;
+        tree->mappingLength = st.st_size;
+        const HeaderEntry* entries = (const HeaderEntry*)(fileHeader + 1);
+        tree->headerTable.assign(entries, entries + fileHeader->headerCount);
+        tree->arena->attach((const FPTreeNode*)(entries + fileHeader->headerCount));
+        tree->root = fileHeader->root;
+        return tree;
     }
 
-    // Mine the FP-Tree recursively
-    void mineTree(FPTreeNode* subtreeRoot, vector<int> prefix, vector<vector<int>>& frequentItemsets) {
-        vector<int> items;
-        for (const auto& entry : headerTable) {
-            items.push_back(entry.first);
+    int minSupport() const { return minSupportCount; }
+    const vector<HeaderEntry>& header() const { return headerTable; }
+    uint32_t rootNode() const { return root; }
+
+    // Nodes from the root down if the tree is a single path, else empty.
+    // Node counts only fall along a path, so it is cut at the first
+    // infrequent node; only a loaded tree has those.
+    vector<uint32_t> singlePath() const {
+        vector<uint32_t> path;
+        const NodeArena& nodes = *arena;
+        for (uint32_t node = nodes[root].firstChild; node != NIL; node = nodes[node].firstChild) {
+            if (nodes[node].nextSibling != NIL) return {};
+            if (nodes[node].count >= minSupportCount) path.push_back(node);
         }
-        sort(items.begin(), items.end(), greater<int>());
+        return path;
+    }
 
-        for (int item : items) {
-            vector<int> newPrefix = prefix;
-            newPrefix.push_back(item);
-            frequentItemsets.push_back(newPrefix);
-
-            vector<vector<int>> conditionalPatternBase;
-            for (FPTreeNode* node : headerTable[item]) {
-                vector<int> path;
-                FPTreeNode* current = node->parent;
-                while (current != root) {
-                    path.push_back(current->item);
-                    current = current->parent;
-                }
-                reverse(path.begin(), path.end());
-                for (int i = 0; i < node->count; ++i) {
-                    conditionalPatternBase.push_back(path);
-                }
+    const FPTreeNode& node(uint32_t index) const { return static_cast<const NodeArena&>(*arena)[index]; }
+
+    // Prefix paths of a header entry's item, each entering the base once
+    // weighted by the node's count
+    WeightedTransactions conditionalPatternBase(const HeaderEntry& entry) const {
+        WeightedTransactions conditionalPatternBase;
+        const NodeArena& nodes = *arena;
+        for (uint32_t node = entry.head; node != NIL; node = nodes[node].nodeLink) {
+            vector<int> path;
+            uint32_t current = nodes[node].parent;
+            while (current != root) {
+                path.push_back(nodes[current].item);
+                current = nodes[current].parent;
             }
+            if (path.empty()) continue;
+            reverse(path.begin(), path.end());
+            conditionalPatternBase.push_back({move(path), nodes[node].count});
+        }
+        return conditionalPatternBase;
+    }
 
-            // Debug: Print conditional pattern base
-            cout << "Conditional Pattern Base for item " << item << ":" << endl;
-            for (const auto& path : conditionalPatternBase) {
-                for (int pItem : path) {
-                    cout << pItem << " ";
-                }
-                cout << endl;
+    // Mining only reads the tree, so one tree can be mined by several threads
+    void mineItem(const HeaderEntry& entry, const vector<int>& prefix, int worker, FPGrowthMiner& miner) const;
+    void mineTree(const vector<int>& prefix, int worker, FPGrowthMiner& miner) const;
+};
+
+// Conditional trees built at one recursion depth (prefix length)
+struct DepthProfile {
+    uint64_t trees = 0;
+    uint64_t singlePaths = 0;   // trees recorded directly as a single path
+    uint64_t nodes = 0;         // cumulative nodes, roots included
+    uint64_t peakTreeNodes = 0; // largest tree
+    uint64_t peakLiveNodes = 0; // most nodes live in one worker's arena
+};
+
+// Parallel FP-Growth. Every header item of the main tree is a task that
+// extracts its conditional pattern base from the shared, read-only tree and
+// mines it. Nested conditional bases with at least SPAWN_MIN_ITEMS path items
+// become tasks of their own; smaller ones are mined inline. Each worker builds
+// its conditional trees on its own arena and records itemsets and debug output
+// in its own buffers.
+class FPGrowthMiner {
+public:
+    static const size_t SPAWN_MIN_ITEMS = 1024;
+
+    FPGrowthMiner(int threads, int minSupportCount) : scheduler(threads), minSupportCount(minSupportCount) {
+        for (int i = 0; i < threads; ++i) workers.emplace_back(new WorkerState);
+    }
+
+    vector<vector<int>> mine(const FPTree& tree) {
+        vector<uint32_t> path = tree.singlePath();
+        if (!path.empty()) {
+            recordPath(0, {}, tree, path);
+        } else {
+            for (const HeaderEntry& entry : tree.header()) {
+                // A loaded tree may hold items frequent only at a lower support
+                if (entry.support < minSupportCount) continue;
+                scheduler.spawn(-1, [this, &tree, &entry](int worker) {
+                    tree.mineItem(entry, {}, worker, *this);
+                    flushLog(worker);
+                });
             }
+            scheduler.run();
+        }
+        return collect();
+    }
+
+    // Mines a projected database under prefix, leaving the itemsets for collect()
+    void mineProjected(const vector<int>& prefix, const WeightedTransactions& base) {
+        if (base.empty()) return;
+        scheduler.spawn(-1, [this, &prefix, &base](int worker) {
+            mineConditional(worker, prefix, base);
+            flushLog(worker);
+        });
+        scheduler.run();
+    }
 
-            if (!conditionalPatternBase.empty()) {
-                FPTree subtree(conditionalPatternBase, minSupportCount);
-                subtree.mineTree(subtree.root, newPrefix, frequentItemsets);
+    // Conditional tree statistics of all workers by depth
+    vector<DepthProfile> depthProfile() const {
+        vector<DepthProfile> merged;
+        for (const auto& worker : workers) {
+            if (merged.size() < worker->depths.size()) merged.resize(worker->depths.size());
+            for (size_t depth = 0; depth < worker->depths.size(); ++depth) {
+                const DepthProfile& p = worker->depths[depth];
+                DepthProfile& m = merged[depth];
+                m.trees += p.trees;
+                m.singlePaths += p.singlePaths;
+                m.nodes += p.nodes;
+                m.peakTreeNodes = max(m.peakTreeNodes, p.peakTreeNodes);
+                m.peakLiveNodes = max(m.peakLiveNodes, p.peakLiveNodes);
             }
         }
+        return merged;
     }
 
-    // Build a conditional FP-Tree for mining
-    void buildConditionalTree(const vector<vector<int>>& conditionalPatternBase, int minSupportCount) {
-        root = new FPTreeNode(-1);
-        headerTable.clear();
-        transactions = conditionalPatternBase;
-        this->minSupportCount = minSupportCount;
-        buildTree();
+    // Takes the itemsets recorded so far, merged in a fixed order
+    vector<vector<int>> collect() {
+        vector<vector<int>> frequentItemsets;
+        for (auto& worker : workers) {
+            move(worker->itemsets.begin(), worker->itemsets.end(), back_inserter(frequentItemsets));
+            worker->itemsets.clear();
+        }
+        sort(frequentItemsets.begin(), frequentItemsets.end());
+        return frequentItemsets;
     }
 
-    // Deallocate memory used by the FP-Tree
-    void deallocateTree(FPTreeNode* node) {
-        for (auto& child : node->children) {
-            deallocateTree(child.second);
+    void record(int worker, const vector<int>& itemset) { workers[worker]->itemsets.push_back(itemset); }
+
+    // Records prefix extended by every non-empty combination of a single
+    // path's items. Nodes deeper in the path come first, as they would have
+    // been mined first.
+    void recordPath(int worker, const vector<int>& prefix, const FPTree& tree, const vector<uint32_t>& path) {
+        vector<vector<int>>& itemsets = workers[worker]->itemsets;
+        size_t first = itemsets.size();
+        for (auto node = path.rbegin(); node != path.rend(); ++node) {
+            int item = tree.node(*node).item;
+            size_t last = itemsets.size();
+            vector<int> itemset = prefix;
+            itemset.push_back(item);
+            itemsets.push_back(move(itemset));
+            for (size_t i = first; i < last; ++i) {
+                itemset = itemsets[i];
+                itemset.push_back(item);
+                itemsets.push_back(move(itemset));
+            }
         }
-        delete node;
     }
+    ostream& log(int worker) { return workers[worker]->log; }
+
+    // Mines the conditional tree of base under prefix
+    void mineBase(int worker, const vector<int>& prefix, WeightedTransactions base) {
+        if (base.empty()) return;
+        size_t pathItems = 0;
+        for (const auto& path : base) {
+            pathItems += path.first.size();
+        }
+        if (scheduler.size() > 1 && pathItems >= SPAWN_MIN_ITEMS) {
+            auto shared = make_shared<pair<vector<int>, WeightedTransactions>>(prefix, move(base));
+            scheduler.spawn(worker, [this, shared](int worker) {
+                mineConditional(worker, shared->first, shared->second);
+                flushLog(worker);
+            });
+        } else {
+            mineConditional(worker, prefix, base);
+        }
+    }
+
+private:
+    struct WorkerState {
+        NodeArena arena;
+        vector<vector<int>> itemsets;
+        ostringstream log;
+        vector<DepthProfile> depths;
+    };
+
+    TaskScheduler scheduler;
+    vector<unique_ptr<WorkerState>> workers;
+    int minSupportCount;
+    mutex logLock;
+
+    void mineConditional(int worker, const vector<int>& prefix, const WeightedTransactions& base) {
+        WorkerState& state = *workers[worker];
+        uint32_t mark = state.arena.mark();
+        FPTree subtree(state.arena, base, minSupportCount, state.log);
+        vector<uint32_t> path = subtree.singlePath();
 
+        if (state.depths.size() <= prefix.size()) state.depths.resize(prefix.size() + 1);
+        DepthProfile& profile = state.depths[prefix.size()];
+        uint64_t nodes = state.arena.mark() - mark;
+        profile.trees++;
+        profile.singlePaths += !path.empty();
+        profile.nodes += nodes;
+        profile.peakTreeNodes = max(profile.peakTreeNodes, nodes);
+        profile.peakLiveNodes = max<uint64_t>(profile.peakLiveNodes, state.arena.mark());
+        if (!path.empty()) {
+            recordPath(worker, prefix, subtree, path);
+        } else {
+            subtree.mineTree(prefix, worker, *this);
+        }
+    }
+
+    // Writes a finished task's debug output in one piece
+    void flushLog(int worker) {
+        ostringstream& buffer = workers[worker]->log;
+        lock_guard<mutex> guard(logLock);
+        cout << buffer.str();
+        buffer.str("");
+    }
+};
+
+// Partition projection for databases whose FP-tree does not fit in memory.
+// Items are ranked by frequency and every transaction is written to the
+// partition file of its least frequent item. Partitions are then taken from
+// the least frequent item up: partition i holds, with weights, every
+// transaction containing i, so its transactions without i are i's projected
+// database. That is mined with an in-memory FP-tree when its estimated size
+// fits the memory budget, and projected again otherwise. Each transaction is
+// then passed on without i to the partition of its next item, so the files
+// together stay about as large as the filtered database. Files go into a
+// fresh subdirectory of the given one, so files left by an interrupted run or
+// written by a concurrent one are never read back.
+class DiskProjection {
 public:
-    // Constructor for main FP-Tree
-    FPTree(const string& filename, int minSupportCount) : minSupportCount(minSupportCount) {
-        root = new FPTreeNode(-1);
-        parseInputFile(filename);
-        buildTree();
+    DiskProjection(const string& parent, size_t memoryBudget, int minSupportCount, FPGrowthMiner& miner)
+        : memoryBudget(memoryBudget), minSupportCount(minSupportCount), miner(miner) {
+        vector<char> pattern(parent.begin(), parent.end());
+        string name = "/fp_projection.XXXXXX";
+        pattern.insert(pattern.end(), name.begin(), name.end());
+        pattern.push_back('\0');
+        if (!mkdtemp(pattern.data())) {
+            cerr << "Projection directory could not be created in " << parent << "\n";
+            exit(1);
+        }
+        directory = pattern.data();
     }
 
-    // Constructor for conditional FP-Tree
-    FPTree(const vector<vector<int>>& conditionalPatternBase, int minSupportCount) : minSupportCount(minSupportCount) {
-        root = new FPTreeNode(-1);
-        buildConditionalTree(conditionalPatternBase, minSupportCount);
+    // Partition files are removed as they are mined; only the directory is left
+    ~DiskProjection() {
+        rmdir(directory.c_str());
     }
 
-    ~FPTree() {
-        deallocateTree(root);
+    DiskProjection(const DiskProjection&) = delete;
+    DiskProjection& operator=(const DiskProjection&) = delete;
+
+    vector<vector<int>> mineFile(const string& filename) {
+        // Same tokenizer as the in-memory build
+        size_t rejected = 0;
+        Scan scan = [&filename, &rejected](const Visitor& visit) {
+            MappedInput input(filename);
+            rejected = forEachTransaction(input.data, 0, input.length,
+                                          [&](const vector<int>& transaction) { visit(transaction, 1); });
+        };
+        mine(scan, {}, 0);
+        warnRejected(rejected);
+        return miner.collect();
     }
 
-    // Get all frequent itemsets using the FP-Growth algorithm
-    vector<vector<int>> getFrequentItemsets() {
-        vector<vector<int>> frequentItemsets;
-        mineTree(root, {}, frequentItemsets);
-        return frequentItemsets;
+private:
+    typedef function<void(const vector<int>& items, int count)> Visitor;
+    typedef function<void(const Visitor& visit)> Scan; // one pass over a database
+
+    // Records are {length, count, ranks...} as int32
+    struct Partition {
+        vector<int32_t> buffer; // records not yet appended to the file
+        uint64_t records = 0;
+        uint64_t items = 0;
+        uint64_t support = 0;
+    };
+
+    string directory; // private to this run
+    size_t memoryBudget;
+    int minSupportCount;
+    FPGrowthMiner& miner;
+
+    string partitionPath(int depth, int rank) const {
+        return directory + "/fp_d" + to_string(depth) + "_r" + to_string(rank) + ".bin";
+    }
+
+    void flush(int depth, int rank, Partition& partition) {
+        if (partition.buffer.empty()) return;
+        FILE* out = fopen(partitionPath(depth, rank).c_str(), "ab");
+        if (!out || fwrite(partition.buffer.data(), sizeof(int32_t), partition.buffer.size(), out) !=
+                        partition.buffer.size()) {
+            cerr << "Projection file could not be written\n";
+            exit(1);
+        }
+        fclose(out);
+        vector<int32_t>().swap(partition.buffer);
+    }
+
+    // Buffers a record whose least frequent item is ranked[last]. A quarter
+    // of the budget goes to buffers; past it every buffer is flushed.
+    void append(int depth, vector<Partition>& partitions, size_t& buffered, const int32_t* ranked, int length,
+                int count) {
+        Partition& partition = partitions[ranked[length - 1]];
+        partition.buffer.push_back(length);
+        partition.buffer.push_back(count);
+        partition.buffer.insert(partition.buffer.end(), ranked, ranked + length);
+        partition.records++;
+        partition.items += length;
+        partition.support += count;
+        buffered += (length + 2) * sizeof(int32_t);
+        if (buffered > memoryBudget / 4) {
+            for (size_t rank = 0; rank < partitions.size(); ++rank) {
+                flush(depth, rank, partitions[rank]);
+            }
+            buffered = 0;
+        }
+    }
+
+    // Calls visit(ranks, length, count) for every record of a partition
+    template <typename RecordVisitor>
+    void readPartition(int depth, int rank, RecordVisitor visit) {
+        FILE* in = fopen(partitionPath(depth, rank).c_str(), "rb");
+        if (!in) return;
+        vector<int32_t> record;
+        int32_t head[2];
+        while (fread(head, sizeof(int32_t), 2, in) == 2) {
+            record.resize(head[0]);
+            if (fread(record.data(), sizeof(int32_t), head[0], in) != (size_t)head[0]) break;
+            visit(record.data(), head[0], head[1]);
+        }
+        fclose(in);
+    }
+
+    // Memory to hold a projection as a pattern base plus its FP-tree
+    size_t estimate(const Partition& partition) const {
+        return partition.items * (sizeof(FPTreeNode) + sizeof(int)) +
+               partition.records * sizeof(WeightedTransactions::value_type);
+    }
+
+    void mine(const Scan& scan, const vector<int>& prefix, int depth) {
+        // Pass 1: item frequencies
+        unordered_map<int, uint64_t> itemFrequency;
+        scan([&](const vector<int>& items, int count) {
+            for (int item : items) {
+                itemFrequency[item] += count;
+            }
+        });
+
+        vector<int> items; // item of each rank, most frequent first
+        for (const auto& pair : itemFrequency) {
+            if (pair.second >= (uint64_t)minSupportCount) {
+                items.push_back(pair.first);
+            }
+        }
+        sort(items.begin(), items.end(), [&](int a, int b) {
+            uint64_t fa = itemFrequency[a], fb = itemFrequency[b];
+            return fa != fb ? fa > fb : a < b;
+        });
+        unordered_map<int, int> ranks;
+        for (int rank = 0; rank < (int)items.size(); ++rank) {
+            ranks[items[rank]] = rank;
+        }
+        itemFrequency.clear();
+
+        // Pass 2: each transaction goes to the partition of its least frequent item
+        vector<Partition> partitions(items.size());
+        size_t buffered = 0;
+        vector<int32_t> ranked;
+        scan([&](const vector<int>& transaction, int count) {
+            ranked.clear();
+            for (int item : transaction) {
+                auto found = ranks.find(item);
+                if (found != ranks.end()) ranked.push_back(found->second);
+            }
+            if (ranked.empty()) return;
+            sort(ranked.begin(), ranked.end());
+            append(depth, partitions, buffered, ranked.data(), ranked.size(), count);
+        });
+
+        for (int rank = items.size() - 1; rank >= 0; --rank) {
+            Partition& partition = partitions[rank];
+            flush(depth, rank, partition);
+            vector<int> newPrefix = prefix;
+            newPrefix.push_back(items[rank]);
+            miner.record(0, newPrefix);
+
+            // Passes a record on without its last item
+            auto passOn = [&](const int32_t* record, int length, int count) {
+                if (length > 1) append(depth, partitions, buffered, record, length - 1, count);
+            };
+
+            if (estimate(partition) <= memoryBudget - memoryBudget / 4) {
+                WeightedTransactions base;
+                readPartition(depth, rank, [&](const int32_t* record, int length, int count) {
+                    if (length > 1) {
+                        vector<int> path(length - 1);
+                        for (int i = 0; i + 1 < length; ++i) {
+                            path[i] = items[record[i]];
+                        }
+                        base.push_back({move(path), count});
+                    }
+                    passOn(record, length, count);
+                });
+                miner.mineProjected(newPrefix, base);
+            } else {
+                // Too large: project i's database again, then pass it on
+                for (size_t other = 0; other < partitions.size(); ++other) {
+                    flush(depth, other, partitions[other]);
+                }
+                buffered = 0;
+                Scan projected = [&](const Visitor& visit) {
+                    vector<int> path;
+                    readPartition(depth, rank, [&](const int32_t* record, int length, int count) {
+                        if (length < 2) return;
+                        path.resize(length - 1);
+                        for (int i = 0; i + 1 < length; ++i) {
+                            path[i] = items[record[i]];
+                        }
+                        visit(path, count);
+                    });
+                };
+                mine(projected, newPrefix, depth + 1);
+                readPartition(depth, rank, passOn);
+            }
+            remove(partitionPath(depth, rank).c_str());
+        }
     }
 };
 
-int main() {
+void FPTree::mineItem(const HeaderEntry& entry, const vector<int>& prefix, int worker, FPGrowthMiner& miner) const {
+    vector<int> newPrefix = prefix;
+    newPrefix.push_back(entry.item);
+    miner.record(worker, newPrefix);
+
+    WeightedTransactions base = conditionalPatternBase(entry);
+
+    // Debug: Print conditional pattern base
+    if (verbosity >= 2) {
+        ostream& out = miner.log(worker);
+        out << "Conditional Pattern Base for item " << entry.item << ":" << endl;
+        for (const auto& path : base) {
+            for (int pItem : path.first) {
+                out << pItem << " ";
+            }
+            out << ": " << path.second << endl;
+        }
+    }
+
+    miner.mineBase(worker, newPrefix, move(base));
+}
+
+// Mine the FP-Tree recursively, least frequent item first
+void FPTree::mineTree(const vector<int>& prefix, int worker, FPGrowthMiner& miner) const {
+    for (auto entry = headerTable.rbegin(); entry != headerTable.rend(); ++entry) {
+        mineItem(*entry, prefix, worker, miner);
+    }
+}
+
+// JSON summary of the main tree's shape (omitted when mining went through
+// --project) and of the conditional trees built at each recursion depth.
+// prefix_sharing is item occurrences per node; 1 means no shared prefixes.
+void writeProfile(ostream& out, const FPTree* tree, const FPGrowthMiner& miner) {
+    out << "{";
+    if (tree) {
+        const vector<HeaderEntry>& header = tree->header();
+        uint64_t occurrences = 0;
+        for (const HeaderEntry& entry : header) {
+            occurrences += entry.support;
+        }
+
+        // Nodes by depth, walking the child links from the root
+        vector<uint64_t> depths;
+        vector<pair<uint32_t, uint32_t>> stack = {{tree->rootNode(), 0}};
+        while (!stack.empty()) {
+            uint32_t node = stack.back().first, depth = stack.back().second;
+            stack.pop_back();
+            if (depth > 0) {
+                if (depths.size() < depth) depths.resize(depth);
+                depths[depth - 1]++;
+            }
+            for (uint32_t child = tree->node(node).firstChild; child != NIL; child = tree->node(child).nextSibling) {
+                stack.push_back({child, depth + 1});
+            }
+        }
+        uint64_t nodes = 0;
+        for (uint64_t count : depths) {
+            nodes += count;
+        }
+
+        out << "\n  \"tree\": {\n    \"nodes\": " << nodes << ",\n    \"bytes_per_node\": " << sizeof(FPTreeNode)
+            << ",\n    \"bytes\": " << nodes * sizeof(FPTreeNode) << ",\n    \"item_occurrences\": " << occurrences
+            << ",\n    \"prefix_sharing\": " << (nodes ? (double)occurrences / nodes : 0)
+            << ",\n    \"depth_histogram\": [";
+        for (size_t depth = 0; depth < depths.size(); ++depth) {
+            out << (depth ? ", " : "") << "{\"depth\": " << depth + 1 << ", \"nodes\": " << depths[depth] << "}";
+        }
+        out << "],\n    \"items\": [";
+        for (size_t i = 0; i < header.size(); ++i) {
+            uint64_t links = 0;
+            for (uint32_t node = header[i].head; node != NIL; node = tree->node(node).nodeLink) {
+                links++;
+            }
+            out << (i ? ",\n      " : "\n      ") << "{\"item\": " << header[i].item << ", \"support\": "
+                << header[i].support << ", \"nodes\": " << links << "}";
+        }
+        out << "]\n  },";
+    }
+
+    vector<DepthProfile> profile = miner.depthProfile();
+    out << "\n  \"conditional_trees\": [";
+    bool first = true;
+    for (size_t depth = 0; depth < profile.size(); ++depth) {
+        const DepthProfile& p = profile[depth];
+        if (p.trees == 0) continue;
+        out << (first ? "\n    " : ",\n    ") << "{\"depth\": " << depth << ", \"trees\": " << p.trees
+            << ", \"single_paths\": " << p.singlePaths << ", \"nodes\": " << p.nodes
+            << ", \"cumulative_bytes\": " << p.nodes * sizeof(FPTreeNode)
+            << ", \"peak_tree_bytes\": " << p.peakTreeNodes * sizeof(FPTreeNode)
+            << ", \"peak_arena_bytes\": " << p.peakLiveNodes * sizeof(FPTreeNode) << "}";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
     string inputFileName = "fp_tree_input.txt";
     string outputFileName = "fp_tree_output.txt";
     int minSupportCount = 2;  // Minimum support count
+    int threads = thread::hardware_concurrency();
+    string savePath, loadPath, projectDir, profilePath;
+    size_t memoryBudget = 1024; // MB, for --project
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--min-support") == 0 && i + 1 < argc) {
+            minSupportCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            loadPath = argv[++i];
+        } else if (strcmp(argv[i], "--project") == 0 && i + 1 < argc) {
+            projectDir = argv[++i];
+        } else if (strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc) {
+            memoryBudget = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            profilePath = argv[++i];
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbosity++;
+        } else if (strcmp(argv[i], "--verbose") == 0 && i + 1 < argc) {
+            verbosity = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            threads = atoi(argv[i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [threads] [--min-support N] [-v | --verbose N] [--profile file|-] "
+                 << "[--save tree.bin | --load tree.bin | --project dir [--memory-mb N]]\n";
+            return 1;
+        }
+    }
+    if (threads < 1) threads = 1;
+    if (minSupportCount < 1) minSupportCount = 1;
+
+    FPGrowthMiner miner(threads, minSupportCount);
+    vector<vector<int>> frequentItemsets;
+
+    // Build once at the lowest support of interest with --save, then mine
+    // at any higher support with --load without parsing the input again.
+    // --project mines through partition files in dir when the whole tree
+    // would not fit in memory.
+    unique_ptr<FPTree> fpTree;
+    if (!projectDir.empty()) {
+        DiskProjection projection(projectDir, max<size_t>(memoryBudget, 1) << 20, minSupportCount, miner);
+        frequentItemsets = projection.mineFile(inputFileName);
+    } else if (!loadPath.empty()) {
+        fpTree = FPTree::load(loadPath, minSupportCount);
+        if (!fpTree) return 1;
+        cout << "Loaded FP-Tree from " << loadPath << endl;
+    } else {
+        fpTree.reset(new FPTree(inputFileName, minSupportCount, threads));
+        if (!savePath.empty()) {
+            if (!fpTree->save(savePath)) {
+                cerr << "Tree file could not be written\n";
+                return 1;
+            }
+            cout << "Saved FP-Tree to " << savePath << endl;
+        }
+    }
 
-    FPTree fpTree(inputFileName, minSupportCount);
-    vector<vector<int>> frequentItemsets = fpTree.getFrequentItemsets();
+    if (fpTree) frequentItemsets = miner.mine(*fpTree);
+
+    if (profilePath == "-") {
+        writeProfile(cout, fpTree.get(), miner);
+    } else if (!profilePath.empty()) {
+        ofstream profileFile(profilePath);
+        if (!profileFile) {
+            cerr << "Profile file could not be written\n";
+            return 1;
+        }
+        writeProfile(profileFile, fpTree.get(), miner);
+    }
 
     // Debug: Print found frequent itemsets
-    cout << "Frequent Itemsets Found:" << endl;
-    for (const auto& itemset : frequentItemsets) {
-        for (int item : itemset) {
-            cout << item << " ";
+    if (verbosity >= 1) {
+        cout << "Frequent Itemsets Found:" << endl;
+        for (const auto& itemset : frequentItemsets) {
+            for (int item : itemset) {
+                cout << item << " ";
+            }
+            cout << endl;
         }
-        cout << endl;
     }
 
     ofstream out_file(outputFileName);
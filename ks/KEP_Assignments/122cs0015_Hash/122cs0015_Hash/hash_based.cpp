@@ -5,165 +5,429 @@
 #include <unordered_set>
 #include <algorithm>
 #include <sstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+
+#include "../../txn_source.h"
 
 using namespace std;
 
-class InputReader {
+// Items are recoded to dense codes 0..n-1 in ascending item order, so sorted
+// code sequences decode to sorted itemsets.
+typedef uint32_t ItemCode;
+typedef unsigned __int128 uint128;
+
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint32_t hashWord(uint64_t key) {
+    return (uint32_t)mix64(key);
+}
+
+inline uint32_t hashWord(uint128 key) {
+    return (uint32_t)mix64((uint64_t)key ^ mix64((uint64_t)(key >> 64)));
+}
+
+// Open-addressing hash table with robin-hood displacement, mapping a key to an
+// int counter. Each slot caches the key's hash so lookups compare keys only on
+// a hash match and growth never rehashes keys.
+template <typename Key>
+class RobinHoodMap {
 private:
-    ifstream fin;
-    vector<vector<int>> transactions;
-public:
-    InputReader(string filename) {
-        fin.open(filename);
-        if (!fin) {
-            cerr << "Input file could not be opened\n";
-            exit(0);
-        }
-        parse();
-    }
-
-    void parse() {
-        string str;
-        while (getline(fin, str)) {
-            vector<int> arr;
-            stringstream ss(str);
-            int num;
-            while (ss >> num) {
-                arr.push_back(num);
+    struct Slot {
+        Key key;
+        uint32_t hash;
+        uint32_t distance; // 0 marks an empty slot, otherwise probe length + 1
+        int value;
+    };
+    vector<Slot> slots;
+    size_t mask;
+    size_t count;
+
+    int& place(uint32_t hash, const Key& key, int value) {
+        Slot incoming = { key, hash, 1, value };
+        Slot* placed = nullptr;
+        size_t pos = hash & mask;
+        while (true) {
+            Slot& slot = slots[pos];
+            if (slot.distance == 0) {
+                slot = incoming;
+                ++count;
+                return placed ? placed->value : slot.value;
             }
-            transactions.push_back(arr);
+            if (slot.distance < incoming.distance) {
+                swap(slot, incoming);
+                if (!placed) placed = &slot;
+            }
+            pos = (pos + 1) & mask;
+            incoming.distance++;
+        }
+    }
+
+    void grow() {
+        vector<Slot> old(slots.size() * 2, Slot());
+        old.swap(slots);
+        mask = slots.size() - 1;
+        count = 0;
+        for (const Slot& slot : old) {
+            if (slot.distance) place(slot.hash, slot.key, slot.value);
         }
     }
 
-    vector<vector<int>> getTransactions() {
-        return transactions;
+public:
+    RobinHoodMap(size_t expected) : count(0) {
+        size_t capacity = 16;
+        while (capacity * 7 < expected * 8) capacity *= 2;
+        slots.assign(capacity, Slot());
+        mask = capacity - 1;
+    }
+
+    // match(key) decides equality once the cached hashes agree
+    template <typename Match>
+    int* find(uint32_t hash, Match match) {
+        size_t pos = hash & mask;
+        for (uint32_t distance = 1;; ++distance) {
+            Slot& slot = slots[pos];
+            if (slot.distance < distance) return nullptr;
+            if (slot.hash == hash && match(slot.key)) return &slot.value;
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    // Key must not be present yet
+    int& insert(uint32_t hash, const Key& key) {
+        if ((count + 1) * 8 > slots.size() * 7) grow();
+        return place(hash, key, 0);
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+// Packs up to sizeof(Word) * 8 / 16 item codes of 16 bits each into one key.
+template <typename Word>
+struct PackedKeys {
+    typedef Word Key;
+    int k;
+
+    Key pack(const ItemCode* items) const {
+        Key key = 0;
+        for (int i = 0; i < k; ++i) key = (key << 16) | items[i];
+        return key;
     }
+    uint32_t hash(const ItemCode* items) const { return hashWord(pack(items)); }
+    bool matches(const Key& key, const ItemCode* items) const { return key == pack(items); }
+    Key store(const ItemCode* items) { return pack(items); }
 };
 
+// Longer itemsets live in an arena; the key is the itemset's offset in it.
+struct ArenaKeys {
+    typedef uint32_t Key;
+    int k;
+    vector<ItemCode> arena;
+
+    uint32_t hash(const ItemCode* items) const {
+        uint64_t h = k;
+        for (int i = 0; i < k; ++i) h = mix64(h ^ items[i]);
+        return (uint32_t)h;
+    }
+    bool matches(Key key, const ItemCode* items) const { return equal(items, items + k, arena.begin() + key); }
+    Key store(const ItemCode* items) {
+        Key offset = arena.size();
+        arena.insert(arena.end(), items, items + k);
+        return offset;
+    }
+};
+
+// Calls visit(subset) for every size-k subset of items, in lexicographic order
+template <typename Visit>
+void forEachSubset(const vector<ItemCode>& items, int k, Visit visit) {
+    int n = items.size();
+    if (n < k) return;
+    vector<int> indices(k);
+    vector<ItemCode> subset(k);
+    for (int i = 0; i < k; ++i) indices[i] = i;
+
+    while (true) {
+        for (int i = 0; i < k; ++i) subset[i] = items[indices[i]];
+        visit(subset.data());
+
+        int i = k - 1;
+        while (i >= 0 && indices[i] == n - k + i) --i;
+        if (i < 0) break;
+        ++indices[i];
+        for (int j = i + 1; j < k; ++j) indices[j] = indices[j - 1] + 1;
+    }
+}
+
+// Direct Hashing and Pruning (Park, Chen and Yu). While level k is counted,
+// every (k+1)-subset of each transaction is hashed into a bucket table; a
+// (k+1)-candidate whose bucket total is below the minimum support cannot be
+// frequent and is dropped before the next pass. Transactions are trimmed of
+// items that cannot belong to any frequent (k+1)-itemset.
+//
+// Itemsets are kept as flat arrays of item codes, k codes per itemset, and
+// counted under packed integer keys: 64-bit up to 4 items, 128-bit up to 8,
+// arena offsets beyond that.
 class DirectHashingAndPruning {
 private:
-    vector<vector<int>> transactions;
+    struct Level {
+        int k;
+        vector<ItemCode> itemsets; // sorted, k codes per itemset
+        vector<int> counts;
+    };
+
+    TxnSource& source;
+    vector<vector<ItemCode>> codedTransactions;
+    vector<int> codeToItem;
     int minSupportCount;
-    unordered_map<string, int> itemsetCounts;
-
-    // Hash function to convert a vector to a string
-    string vectorToString(const vector<int>& vec) {
-        stringstream ss;
-        for (int num : vec) {
-            ss << num << ",";
-        }
-        string str = ss.str();
-        if (!str.empty()) str.pop_back(); // Remove trailing comma
-        return str;
-    }
-
-    // Generate candidate itemsets of length k
-    vector<vector<int>> generateCandidates(const vector<vector<int>>& itemsets, int k) {
-        vector<vector<int>> candidates;
-        for (size_t i = 0; i < itemsets.size(); ++i) {
-            for (size_t j = i + 1; j < itemsets.size(); ++j) {
-                vector<int> candidate(itemsets[i]);
-                candidate.insert(candidate.end(), itemsets[j].begin(), itemsets[j].end());
-                sort(candidate.begin(), candidate.end());
-                candidate.erase(unique(candidate.begin(), candidate.end()), candidate.end());
-
-                if (candidate.size() == k) {
-                    candidates.push_back(candidate);
-                }
+    int numBuckets;
+    vector<int> bucketCounts;
+    vector<Level> levels;
+
+    // Buckets hash the original item ids, so pass 1 can hash before recoding
+    int bucketOf(const ItemCode* codes, int k) const {
+        size_t hash = 0;
+        for (int i = 0; i < k; ++i) {
+            hash = hash * 1000003 + codeToItem[codes[i]];
+        }
+        return hash % numBuckets;
+    }
+
+    static bool containsItemset(const Level& level, const ItemCode* itemset) {
+        int k = level.k;
+        size_t lo = 0, hi = level.itemsets.size() / k;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            const ItemCode* probe = &level.itemsets[mid * k];
+            if (lexicographical_compare(probe, probe + k, itemset, itemset + k)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
             }
         }
-        return candidates;
+        return lo < level.itemsets.size() / k && equal(itemset, itemset + k, &level.itemsets[lo * k]);
     }
 
-    // Count itemsets in transactions
-    void countItemsets(const vector<vector<int>>& candidates) {
-        unordered_map<string, int> localItemsetCounts;
-        for (const auto& transaction : transactions) {
-            for (const auto& candidate : candidates) {
-                if (includes(transaction.begin(), transaction.end(), candidate.begin(), candidate.end())) {
-                    localItemsetCounts[vectorToString(candidate)]++;
+    // Join frequent (k-1)-itemsets sharing their first k-2 items, prune those
+    // with an infrequent subset, then drop candidates whose bucket is too light.
+    vector<ItemCode> generateCandidates(const Level& prev, size_t& joined) {
+        int k = prev.k + 1;
+        size_t n = prev.itemsets.size() / prev.k;
+        vector<ItemCode> candidates;
+        vector<ItemCode> candidate(k), subset(k - 1);
+        joined = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            const ItemCode* a = &prev.itemsets[i * prev.k];
+            for (size_t j = i + 1; j < n; ++j) {
+                const ItemCode* b = &prev.itemsets[j * prev.k];
+                if (!equal(a, a + k - 2, b)) break;
+
+                copy(a, a + k - 1, candidate.begin());
+                candidate[k - 1] = b[k - 2];
+
+                bool allSubsetsFrequent = true;
+                for (int skip = 0; skip + 2 < k && allSubsetsFrequent; ++skip) {
+                    for (int m = 0, s = 0; m < k; ++m) {
+                        if (m != skip) subset[s++] = candidate[m];
+                    }
+                    allSubsetsFrequent = containsItemset(prev, subset.data());
+                }
+                if (!allSubsetsFrequent) continue;
+
+                joined++;
+                if (bucketCounts[bucketOf(candidate.data(), k)] >= minSupportCount) {
+                    candidates.insert(candidates.end(), candidate.begin(), candidate.end());
                 }
             }
         }
+        return candidates;
+    }
 
-        for (const auto& pair : localItemsetCounts) {
-            itemsetCounts[pair.first] += pair.second;
+    // Count C_k, trim each transaction and hash its (k+1)-subsets for the next level
+    template <typename Keys>
+    vector<int> countItemsets(Keys keys, const vector<ItemCode>& candidates, int k) {
+        typedef typename Keys::Key Key;
+        size_t n = candidates.size() / k;
+        RobinHoodMap<Key> counts(n);
+        for (size_t c = 0; c < n; ++c) {
+            const ItemCode* candidate = &candidates[c * k];
+            counts.insert(keys.hash(candidate), keys.store(candidate));
         }
-    }
 
-    // Generate frequent itemsets from counts
-    vector<vector<int>> generateFrequentItemsets() {
-        vector<vector<int>> frequentItemsets;
-        for (const auto& pair : itemsetCounts) {
-            if (pair.second >= minSupportCount) {
-                vector<int> itemset;
-                stringstream ss(pair.first);
-                string item;
-                while (getline(ss, item, ',')) {
-                    itemset.push_back(stoi(item));
+        vector<vector<ItemCode>> trimmedTransactions;
+        vector<int> occurrences(codeToItem.size(), 0);
+        bucketCounts.assign(numBuckets, 0);
+
+        // Later passes read the trimmed copy, not the file
+        source.noteMemoryScan(codedTransactions.size());
+        for (const auto& transaction : codedTransactions) {
+            forEachSubset(transaction, k, [&](const ItemCode* subset) {
+                int* count = counts.find(keys.hash(subset), [&](const Key& key) { return keys.matches(key, subset); });
+                if (count) {
+                    ++*count;
+                    for (int i = 0; i < k; ++i) occurrences[subset[i]]++;
                 }
-                frequentItemsets.push_back(itemset);
+            });
+
+            // An item of a frequent (k+1)-itemset in this transaction lies in k of its candidate k-subsets.
+            vector<ItemCode> trimmed;
+            for (ItemCode item : transaction) {
+                if (occurrences[item] >= k) trimmed.push_back(item);
+                occurrences[item] = 0;
+            }
+            if ((int)trimmed.size() > k) {
+                forEachSubset(trimmed, k + 1, [&](const ItemCode* subset) {
+                    bucketCounts[bucketOf(subset, k + 1)]++;
+                });
+                trimmedTransactions.push_back(move(trimmed));
             }
         }
-        return frequentItemsets;
+        codedTransactions = move(trimmedTransactions);
+
+        vector<int> result(n);
+        for (size_t c = 0; c < n; ++c) {
+            const ItemCode* candidate = &candidates[c * k];
+            result[c] = *counts.find(keys.hash(candidate), [&](const Key& key) { return keys.matches(key, candidate); });
+        }
+        return result;
+    }
+
+    vector<int> countCandidates(const vector<ItemCode>& candidates, int k) {
+        bool fits16 = codeToItem.size() <= 0x10000;
+        if (fits16 && k <= 4) return countItemsets(PackedKeys<uint64_t>{ k }, candidates, k);
+        if (fits16 && k <= 8) return countItemsets(PackedKeys<uint128>{ k }, candidates, k);
+        return countItemsets(ArenaKeys{ k, {} }, candidates, k);
     }
 
 public:
-    DirectHashingAndPruning(vector<vector<int>> _transactions, int _minSupportCount)
-        : transactions(_transactions), minSupportCount(_minSupportCount) {}
+    DirectHashingAndPruning(TxnSource& _source, int _minSupportCount, int _numBuckets)
+        : source(_source), minSupportCount(_minSupportCount), numBuckets(_numBuckets) {}
 
     void process() {
-        vector<vector<int>> itemsets;
+        // Pass 1, the only one over the file: count single items and hash every 2-subset
+        vector<vector<int>> transactions;
+        vector<int> transaction;
+        unordered_map<int, int> singleItemCounts;
+        bucketCounts.assign(numBuckets, 0);
+        source.rewind();
+        while (source.next(transaction)) {
+            transactions.push_back(transaction);
+            for (size_t i = 0; i < transaction.size(); ++i) {
+                singleItemCounts[transaction[i]]++;
+                for (size_t j = i + 1; j < transaction.size(); ++j) {
+                    bucketCounts[((size_t)transaction[i] * 1000003 + transaction[j]) % numBuckets]++;
+                }
+            }
+        }
+
+        // Recode frequent items in ascending item order
+        for (const auto& pair : singleItemCounts) {
+            if (pair.second >= minSupportCount) codeToItem.push_back(pair.first);
+        }
+        sort(codeToItem.begin(), codeToItem.end());
+        unordered_map<int, ItemCode> itemToCode;
+        Level first = { 1, {}, {} };
+        for (size_t code = 0; code < codeToItem.size(); ++code) {
+            itemToCode[codeToItem[code]] = code;
+            first.itemsets.push_back(code);
+            first.counts.push_back(singleItemCounts[codeToItem[code]]);
+        }
 
-        // Initialize with single-item itemsets
-        unordered_map<string, int> singleItemsetCounts;
         for (const auto& transaction : transactions) {
+            vector<ItemCode> coded;
             for (int item : transaction) {
-                vector<int> itemset = { item };
-                string key = vectorToString(itemset);
-                singleItemsetCounts[key]++;
+                auto it = itemToCode.find(item);
+                if (it != itemToCode.end()) coded.push_back(it->second);
             }
+            if (coded.size() > 1) codedTransactions.push_back(move(coded));
         }
+        transactions.clear();
 
-        // Filter single itemsets by minSupportCount
-        for (const auto& pair : singleItemsetCounts) {
-            if (pair.second >= minSupportCount) {
-                vector<int> itemset = { stoi(pair.first) };
-                itemsets.push_back(itemset);
-                itemsetCounts[pair.first] = pair.second;
-            }
-        }
+        levels.push_back(move(first));
+        cout << "Level 1 - Frequent Itemsets: " << levels.back().counts.size() << endl;
 
         // Generate larger itemsets
         int k = 2;
-        while (true) {
-            vector<vector<int>> candidates = generateCandidates(itemsets, k);
+        while (!levels.back().counts.empty()) {
+            size_t joined;
+            vector<ItemCode> candidates = generateCandidates(levels.back(), joined);
             if (candidates.empty()) break;
 
-            countItemsets(candidates);
-            vector<vector<int>> newFrequentItemsets = generateFrequentItemsets();
+            vector<int> counts = countCandidates(candidates, k);
+            Level level = { k, {}, {} };
+            for (size_t c = 0; c < counts.size(); ++c) {
+                if (counts[c] >= minSupportCount) {
+                    level.itemsets.insert(level.itemsets.end(), candidates.begin() + c * k, candidates.begin() + (c + 1) * k);
+                    level.counts.push_back(counts[c]);
+                }
+            }
 
-            if (newFrequentItemsets.empty()) break;
-            itemsets = newFrequentItemsets;
+            cout << "Level " << k << " - Candidates: " << candidates.size() / k << " (" << joined
+                 << " before hash filter), Frequent Itemsets: " << level.counts.size()
+                 << ", Transactions kept: " << codedTransactions.size() << endl;
+            levels.push_back(move(level));
             k++;
         }
     }
 
     vector<vector<int>> getAllFrequentItemsets() {
-        return generateFrequentItemsets();
+        vector<vector<int>> frequentItemsets;
+        for (const Level& level : levels) {
+            for (size_t i = 0; i < level.counts.size(); ++i) {
+                vector<int> itemset;
+                for (int j = 0; j < level.k; ++j) {
+                    itemset.push_back(codeToItem[level.itemsets[i * level.k + j]]);
+                }
+                frequentItemsets.push_back(itemset);
+            }
+        }
+        return frequentItemsets;
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
     string inputFileName = "hash_input.txt";
     string outputFileName = "hash_output.txt";
     int minSupportCount = 3;  // Minimum support count
+    int numBuckets = 1009;  // Size of the DHP bucket table
+    if (argc > 1) {
+        char* end;
+        errno = 0;
+        long value = strtol(argv[1], &end, 10);
+        if (argc > 2 || end == argv[1] || *end != '\0' || errno != 0 || value < 1 || value > INT_MAX) {
+            cerr << "Usage: " << argv[0] << " [num_buckets]  (a positive integer, default 1009)\n";
+            return 1;
+        }
+        numBuckets = value;
+    }
 
-    InputReader inputReader(inputFileName);
-    vector<vector<int>> transactions = inputReader.getTransactions();
+    TxnSource source(inputFileName);
+    if (!source.ok()) {
+        cerr << "Input file could not be opened\n";
+        return 1;
+    }
 
-    DirectHashingAndPruning dhp(transactions, minSupportCount);
+    auto start = chrono::steady_clock::now();
+    DirectHashingAndPruning dhp(source, minSupportCount, numBuckets);
     dhp.process();
+    vector<vector<int>> frequentItemsets = dhp.getAllFrequentItemsets();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t longest = 0;
+    for (const auto& itemset : frequentItemsets) longest = max(longest, itemset.size());
+    reportIo("DHP", source, longest, seconds);
 
     ofstream out_file(outputFileName);
     if (!out_file) {
@@ -172,7 +436,7 @@ int main() {
     }
 
     out_file << "Frequent itemsets:\n";
-    for (const auto& itemset : dhp.getAllFrequentItemsets()) {
+    for (const auto& itemset : frequentItemsets) {
         out_file << "{ ";
         for (const auto& item : itemset) {
             out_file << item << ' ';
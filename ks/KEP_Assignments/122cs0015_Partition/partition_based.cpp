@@ -8,6 +8,15 @@
 #include <iomanip>
 #include <algorithm>
 #include <random>
+#include <map>
+#include <numeric>
+#include <iterator>
+#include <limits>
+#include <unistd.h>
+#include <chrono>
+
+#include "../txn_source.h"
+#include "../../../LAB4/mining_common.h"
 using namespace std;
 
 // Helper functions
@@ -108,120 +117,174 @@ public:
     }
 };
 
-// Partition-Based Frequent Itemset Mining
+// Partition-Based Frequent Itemset Mining (Savasere et al.)
+// Phase 1 mines each partition level-wise over TID lists at the local
+// threshold; an itemset frequent in the whole database is frequent in at
+// least one partition, so the union of local results is a complete candidate
+// set. Phase 2 counts that union exactly in one scan of all transactions.
+// Both phases stream the file through a TxnSource; phase 1 cuts it into
+// byte ranges of equal size and holds one partition in memory at a time;
+// when sized from the memory budget, a partition whose TID lists outgrow it
+// is halved until the pieces fit.
 class PartitionBasedMining {
+public:
+    struct PartitionReport {
+        size_t first, last;     // transaction range
+        size_t estimatedBytes;  // TID-list footprint predicted from the item histogram, 0 if not sized
+        size_t peakBytes;       // largest TID-list footprint held while mining
+    };
+
 private:
-    vector<vector<int>> transactions;
+    TxnSource& source;
     long double minSupport;
     int numPartitions;
+    size_t memoryBudget;
+    long double bytesPerTransaction = 0;
     vector<vector<int>> allFrequentItemsets;
+    vector<int> supports;
+    vector<PartitionReport> reports;
     
-    vector<vector<int>> findFrequentItemsets(const vector<vector<int>>& partition) {
-        vector<vector<int>> frequentItemsets;
-        set<vector<int>> itemsetSet;
-        
-        // Generate all itemsets (single items, pairs, etc.)
-        set<int> items;
-        for (const auto& trans : partition) {
+    // Smallest count reaching minSupport percent of n transactions
+    int minCount(size_t n) const {
+        long double count = minSupport * n / 100.0;
+        int result = (int)ceil(count - 1e-9);
+        return max(result, 1);
+    }
+    
+    // Expected TID-list bytes per transaction, from one pass over the item
+    // histogram. This pass is only made when sizing partitions.
+    long double estimateBytesPerTransaction(size_t& n) {
+        map<int, size_t> histogram;
+        vector<int> trans;
+        n = 0;
+        source.rewind();
+        while (source.next(trans)) {
+            ++n;
             for (int item : trans) {
-                items.insert(item);
+                ++histogram[item];
             }
         }
-        
-        vector<int> itemVec(items.begin(), items.end());
-        
-        // Check single items
-        for (int item : itemVec) {
-            vector<int> itemset = {item};
-            long double support = getSupport(partition, itemset);
-            if (support >= minSupport) {
-                frequentItemsets.push_back(itemset);
-                itemsetSet.insert(itemset);
-            }
+        return n ? estimateTidBytesPerTransaction(histogram, n, minCount(n)) : 0;
+    }
+    
+    // Fewest partitions whose estimated footprint fits the memory budget
+    int partitionsForBudget(size_t n) const {
+        long double total = bytesPerTransaction * n;
+        int partitions = (int)ceil(total / memoryBudget);
+        return max(1, min(partitions, (int)n));
+    }
+    
+    // Phase 1: mines transactions [first, last) of the partition in memory,
+    // which start at transaction offset of the file. A range whose TID lists
+    // pass limit bytes is halved and each half mined in turn, so every piece
+    // fits; a single transaction is mined whatever it holds. Local thresholds
+    // stay proportional to piece size, which keeps the candidates complete.
+    void minePartition(const vector<vector<int>>& partition, size_t first, size_t last, size_t offset, size_t limit,
+                       set<vector<int>>& candidates) {
+        size_t size = last - first;
+        TidMiningResult result = mineTidLists(partition, first, last, minCount(size), size > 1 ? limit : SIZE_MAX);
+        if (result.overBudget) {
+            size_t middle = first + size / 2;
+            minePartition(partition, first, middle, offset, limit, candidates);
+            minePartition(partition, middle, last, offset, limit, candidates);
+            return;
         }
-        
-        // Check pairs, triplets, etc.
-        for (size_t r = 2; r <= itemVec.size(); ++r) {
-            vector<vector<int>> combinations;
-            generateCombinations(itemVec, r, combinations);
-            
-            for (const auto& combo : combinations) {
-                long double support = getSupport(partition, combo);
-                if (support >= minSupport) {
-                    frequentItemsets.push_back(combo);
-                    itemsetSet.insert(combo);
-                }
-            }
+        for (auto& itemset : result.itemsets) {
+            candidates.insert(move(itemset));
         }
-        
-        return frequentItemsets;
+        reports.push_back({offset + first, offset + last, (size_t)(bytesPerTransaction * size), result.peakBytes});
     }
     
-    long double getSupport(const vector<vector<int>>& partition, const vector<int>& itemset) {
-        int count = 0;
-        for (const auto& trans : partition) {
-            if (includes(trans.begin(), trans.end(), itemset.begin(), itemset.end())) {
-                ++count;
-            }
+public:
+    // numPartitions <= 0 sizes partitions so each one's TID lists fit in
+    // memoryBudget bytes; a budget of 0 uses the detected cache size.
+    PartitionBasedMining(TxnSource& source, long double minSupport, int numPartitions, size_t memoryBudget = 0)
+        : source(source), minSupport(minSupport), numPartitions(numPartitions), memoryBudget(memoryBudget) {
+        if (this->memoryBudget == 0) {
+            this->memoryBudget = detectCacheBytes();
+        }
+        if (this->memoryBudget == 0) {
+            this->memoryBudget = 8 << 20;
         }
-        return static_cast<long double>(count) / partition.size() * 100.0;
     }
     
-    void generateCombinations(const vector<int>& items, size_t r, vector<vector<int>>& combinations) {
-        vector<int> indices(r);
-        iota(indices.begin(), indices.end(), 0);
+    void process() {
+        reports.clear();
+        allFrequentItemsets.clear();
+        supports.clear();
         
-        while (true) {
-            vector<int> combo;
-            for (size_t i = 0; i < r; ++i) {
-                combo.push_back(items[indices[i]]);
+        // Only partitions sized from the budget are held to it; an explicit
+        // partition count is taken as given.
+        size_t limit = SIZE_MAX;
+        if (numPartitions <= 0) {
+            size_t n;
+            bytesPerTransaction = estimateBytesPerTransaction(n);
+            if (n == 0) return;
+            numPartitions = partitionsForBudget(n);
+            limit = memoryBudget;
+        }
+        
+        // Partition i holds the transactions starting in bytes
+        // [i * size / P, (i + 1) * size / P) of the file
+        set<vector<int>> candidates;
+        vector<vector<int>> partition;
+        vector<int> trans;
+        size_t n = 0;
+        bool more = true;
+        source.rewind();
+        for (int i = 0; i < numPartitions && more; ++i) {
+            size_t boundary = source.bytes() * (i + 1) / numPartitions;
+            partition.clear();
+            // The last partition reads on to the end of the file, closing the pass
+            bool last = i == numPartitions - 1;
+            while ((last || source.tell() < boundary) && (more = source.next(trans))) {
+                partition.push_back(trans);
             }
-            combinations.push_back(combo);
+            if (partition.empty()) continue;
             
-            size_t i = r;
-            while (i-- > 0) {
-                if (indices[i] != i + items.size() - r) {
-                    break;
+            minePartition(partition, 0, partition.size(), n, limit, candidates);
+            n += partition.size();
+        }
+        partition.clear();
+        if (n == 0) return;
+        
+        // Phase 2: one scan of the whole database counts every candidate
+        vector<vector<int>> candidateList(candidates.begin(), candidates.end());
+        vector<int> counts(candidateList.size(), 0);
+        source.rewind();
+        while (source.next(trans)) {
+            for (size_t c = 0; c < candidateList.size(); ++c) {
+                const vector<int>& itemset = candidateList[c];
+                if (includes(trans.begin(), trans.end(), itemset.begin(), itemset.end())) {
+                    ++counts[c];
                 }
             }
-            
-            if (i == static_cast<size_t>(-1)) break;
-            
-            ++indices[i];
-            for (size_t j = i + 1; j < r; ++j) {
-                indices[j] = indices[j - 1] + 1;
-            }
         }
-    }
-    
-public:
-    PartitionBasedMining(const vector<vector<int>>& transactions, long double minSupport, int numPartitions)
-        : transactions(transactions), minSupport(minSupport), numPartitions(numPartitions) {}
-    
-    void process() {
-        int partitionSize = transactions.size() / numPartitions;
-        vector<vector<int>> partitionFrequentItemsets;
         
-        for (int i = 0; i < numPartitions; ++i) {
-            vector<vector<int>> partition;
-            if (i == numPartitions - 1) {
-                partition.assign(transactions.begin() + i * partitionSize, transactions.end());
-            } else {
-                partition.assign(transactions.begin() + i * partitionSize, transactions.begin() + (i + 1) * partitionSize);
+        int globalMin = minCount(n);
+        for (size_t c = 0; c < candidateList.size(); ++c) {
+            if (counts[c] >= globalMin) {
+                allFrequentItemsets.push_back(candidateList[c]);
+                supports.push_back(counts[c]);
             }
-            
-            vector<vector<int>> frequentItemsets = findFrequentItemsets(partition);
-            partitionFrequentItemsets.insert(partitionFrequentItemsets.end(), frequentItemsets.begin(), frequentItemsets.end());
         }
-        
-        // Merge frequent itemsets from all partitions
-        set<vector<int>> mergedItemsets(partitionFrequentItemsets.begin(), partitionFrequentItemsets.end());
-        allFrequentItemsets.assign(mergedItemsets.begin(), mergedItemsets.end());
     }
     
     vector<vector<int>> getAllFrequentItemsets() const {
         return allFrequentItemsets;
     }
+    
+    vector<int> getSupports() const {
+        return supports;
+    }
+    
+    size_t getMemoryBudget() const {
+        return memoryBudget;
+    }
+    
+    vector<PartitionReport> getReports() const {
+        return reports;
+    }
 };
 
 // Input Reader
@@ -261,7 +324,9 @@ public:
 };
 
 // Main Function
-int main() {
+// Usage: partition_based [min_support_percent] [partitions] [memory_budget_kb]
+// Partitions default to 0, which sizes them from the budget (or cache size).
+int main(int argc, char* argv[]) {
     // Load transactions
     InputReader inputReader("partition_input.txt");
     vector<vector<int>> transactions = inputReader.getTransactions();
@@ -279,16 +344,36 @@ int main() {
     kmeans.printCentroids(out_file);
     
     // Perform partition-based frequent itemset mining
-    PartitionBasedMining pbMining(transactions, 20.0, 4); // Example minSupport = 20%, 4 partitions
+    long double minSupport = argc > 1 ? atof(argv[1]) : 20.0;
+    int numPartitions = argc > 2 ? atoi(argv[2]) : 0;
+    size_t memoryBudget = argc > 3 ? (size_t)atol(argv[3]) << 10 : 0;
+    TxnSource source("partition_input.txt");
+    auto start = chrono::steady_clock::now();
+    PartitionBasedMining pbMining(source, minSupport, numPartitions, memoryBudget);
     pbMining.process();
+    vector<vector<int>> itemsets = pbMining.getAllFrequentItemsets();
+    vector<int> supports = pbMining.getSupports();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    size_t longest = 0;
+    for (const auto& itemset : itemsets) longest = max(longest, itemset.size());
+    reportIo("Partition", source, longest, seconds);
+    
+    // Depends on the machine, so it stays out of the output file
+    cout << "Memory budget: " << pbMining.getMemoryBudget() << " bytes" << endl;
+    for (const auto& report : pbMining.getReports()) {
+        out_file << "Partition [" << report.first << ", " << report.last << "): ";
+        if (report.estimatedBytes > 0) out_file << "estimated " << report.estimatedBytes << " bytes, ";
+        out_file << "peak " << report.peakBytes << " bytes\n";
+    }
     
     out_file << "Frequent itemsets:\n";
-    for (const auto& itemset : pbMining.getAllFrequentItemsets()) {
+    for (size_t i = 0; i < itemsets.size(); ++i) {
         out_file << "{ ";
-        for (const auto& item : itemset) {
+        for (const auto& item : itemsets[i]) {
             out_file << item << ' ';
         }
-        out_file << "}\n";
+        out_file << "} support " << supports[i] << "\n";
     }
     
     out_file.close();
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+#include <string>
+
+using namespace std;
+
+// Comparison table for the CSV rows that txn_source.h's reportIo() appends
+// to $IO_REPORT. For each dataset it lists every run with its passes over the
+// file, the scans it saved against level-wise Apriori (one scan per itemset
+// size), the bytes served from disk and from the page cache, and wall time.
+//
+// Usage: io_report <io_report.csv> [more.csv ...]
+//
+// Example:
+//   export IO_REPORT=$PWD/io.csv TXN_COLD=1
+//   (cd 122cs0015_DIC && ./dic) ; (cd 122cs0015_Partition && ./partition_based) ...
+//   ./io_report io.csv
+
+struct Run {
+    string algorithm;
+    double fileTransactions, fullPasses, partialPasses, transactionsRead;
+    double bytesDisk, bytesCache, memoryTransactions, levelWiseScans, seconds;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cout << "Usage: " << argv[0] << " <io_report.csv> [more.csv ...]" << endl;
+        return 1;
+    }
+
+    map<string, vector<Run>> byDataset;
+    for (int f = 1; f < argc; ++f) {
+        ifstream in(argv[f]);
+        if (!in) {
+            cerr << "Cannot open " << argv[f] << endl;
+            return 1;
+        }
+        string line;
+        getline(in, line); // header
+        while (getline(in, line)) {
+            stringstream ss(line);
+            string dataset, field;
+            Run run;
+            getline(ss, run.algorithm, ',');
+            getline(ss, dataset, ',');
+            double* fields[] = {&run.fileTransactions, &run.fullPasses, &run.partialPasses, &run.transactionsRead,
+                                &run.bytesDisk, &run.bytesCache, &run.memoryTransactions, &run.levelWiseScans,
+                                &run.seconds};
+            bool ok = !dataset.empty();
+            for (double* value : fields) {
+                ok = ok && getline(ss, field, ',');
+                *value = ok ? atof(field.c_str()) : 0;
+            }
+            if (ok) byDataset[dataset].push_back(run);
+        }
+    }
+
+    for (const auto& entry : byDataset) {
+        cout << entry.first << endl;
+        cout << left << setw(16) << "algorithm" << right << setw(8) << "passes" << setw(10) << "file eq." << setw(11)
+             << "memory eq." << setw(11) << "level-wise" << setw(8) << "saved" << setw(12) << "disk KB" << setw(12)
+             << "cache KB" << setw(11) << "seconds" << endl;
+        for (const Run& run : entry.second) {
+            // Passes equivalent to the transactions read, from the file and from memory
+            double n = run.fileTransactions > 0 ? run.fileTransactions : 1;
+            double fileEq = run.transactionsRead / n;
+            double memoryEq = run.memoryTransactions / n;
+            ostringstream passes;
+            passes << run.fullPasses << "+" << run.partialPasses;
+            cout << left << setw(16) << run.algorithm << right << setw(8) << passes.str() << fixed
+                 << setprecision(2) << setw(10) << fileEq << setw(11) << memoryEq << setw(11)
+                 << setprecision(0) << run.levelWiseScans << setprecision(2) << setw(8)
+                 << run.levelWiseScans - fileEq << setprecision(1) << setw(12) << run.bytesDisk / 1024
+                 << setw(12) << run.bytesCache / 1024 << setprecision(4) << setw(11) << run.seconds << endl;
+            cout.unsetf(ios::fixed);
+        }
+        cout << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,248 @@
+#ifndef TXN_SOURCE_H
+#define TXN_SOURCE_H
+
+// Transaction file reader with I/O accounting, shared by the Apriori (DHP),
+// DIC and Partition miners. The file is mmapped and every database pass goes
+// through rewind()/seek() and next(), so the source can tell how many full
+// and partial passes a miner made, how many transactions it read, and how
+// many bytes came from disk versus the page cache. Page residency is taken
+// with mincore() when a pass begins; a page counts as a cache hit if it was
+// resident then. Setting TXN_COLD=1 drops the file from the page cache before
+// every pass, approximating cold storage.
+//
+// Passes a miner makes over its own in-memory copy of the data do not touch
+// the file; it reports them with noteMemoryScan() so they still show up.
+//
+// reportIo() prints a summary and, if IO_REPORT names a file, appends one CSV
+// row to it; io_report.cpp turns those rows into a comparison table.
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct IoStats {
+    uint64_t fullPasses = 0;         // passes from the first transaction to the end of the file
+    uint64_t partialPasses = 0;      // passes that started later or stopped early
+    uint64_t transactions = 0;       // transactions read from the file
+    uint64_t bytesDisk = 0;          // bytes of pages not resident when their pass began
+    uint64_t bytesCache = 0;         // bytes of pages resident when their pass began
+    uint64_t memoryTransactions = 0; // transactions rescanned from a miner's own copy
+    uint64_t skippedTokens = 0;      // tokens read that are not ints
+};
+
+class TxnSource {
+private:
+    std::string path;
+    int skipFields;
+    bool cold;
+    int fd = -1;
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t page;
+
+    size_t pos = 0;
+    bool inPass = false;
+    size_t passStart = 0;
+    size_t nextPage = 0; // first page of this pass not yet accounted
+    std::vector<unsigned char> resident;
+    size_t passTransactions = 0;
+    size_t numTransactions = 0; // known after the first full pass
+    IoStats counters;
+
+    void beginPass(size_t offset) {
+        endPass(false);
+        if (cold && data) {
+            // Our own mapping pins its pages; unmap them before evicting
+            madvise((void*)data, length, MADV_DONTNEED);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+        size_t pages = (length + page - 1) / page;
+        resident.assign(pages, 0);
+        if (pages > 0 && mincore((void*)data, length, resident.data()) != 0) {
+            resident.assign(pages, 0);
+        }
+        inPass = true;
+        passStart = offset;
+        passTransactions = 0;
+        pos = offset;
+        nextPage = offset / page;
+    }
+
+    void endPass(bool atEnd) {
+        if (!inPass) return;
+        if (atEnd && passStart == 0) {
+            counters.fullPasses++;
+        } else {
+            counters.partialPasses++;
+        }
+        inPass = false;
+    }
+
+    // Attributes the pages under [begin, end) not yet seen in this pass
+    void account(size_t begin, size_t end) {
+        if (end <= begin) return;
+        size_t last = (end - 1) / page;
+        for (size_t p = std::max(nextPage, begin / page); p <= last; ++p) {
+            size_t bytes = std::min(page, length - p * page);
+            if (resident[p] & 1) {
+                counters.bytesCache += bytes;
+            } else {
+                counters.bytesDisk += bytes;
+            }
+        }
+        nextPage = std::max(nextPage, last + 1);
+    }
+
+public:
+    // skipFields leading numbers of every line (ids) are not items
+    TxnSource(const std::string& path, int skipFields = 0) : path(path), skipFields(skipFields) {
+        const char* env = getenv("TXN_COLD");
+        cold = env && atoi(env) != 0;
+        page = sysconf(_SC_PAGESIZE);
+
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) != 0) return;
+        length = st.st_size;
+        if (length == 0) return;
+        void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            length = 0;
+            return;
+        }
+        data = (const char*)mapped;
+    }
+
+    ~TxnSource() {
+        if (data) munmap((void*)data, length);
+        if (fd >= 0) close(fd);
+    }
+
+    TxnSource(const TxnSource&) = delete;
+    TxnSource& operator=(const TxnSource&) = delete;
+
+    bool ok() const { return fd >= 0; }
+    const std::string& name() const { return path; }
+    size_t bytes() const { return length; }
+    size_t tell() const { return pos; }
+
+    // Transactions in the file; 0 until a full pass has completed
+    size_t size() const { return numTransactions; }
+
+    // Starts a pass at the first transaction
+    void rewind() { beginPass(0); }
+
+    // Starts a pass at the first line beginning at or after byte offset
+    void seek(size_t offset) {
+        offset = std::min(offset, length);
+        if (offset > 0 && data[offset - 1] != '\n') {
+            const char* nl = (const char*)memchr(data + offset, '\n', length - offset);
+            offset = nl ? nl - data + 1 : length;
+        }
+        beginPass(offset);
+    }
+
+    // Reads the next transaction as sorted, unique items. Items are separated
+    // by whitespace or commas; a token that is not an int, such as a lone '-'
+    // or "4x", is skipped and counted. Lines without an int are skipped.
+    // Returns false at the end of the file, which ends the pass.
+    bool next(std::vector<int>& items) {
+        if (!inPass) return false;
+        while (pos < length) {
+            size_t begin = pos;
+            const char* nl = (const char*)memchr(data + pos, '\n', length - pos);
+            size_t end = nl ? nl - data : length;
+            pos = nl ? end + 1 : length;
+            account(begin, pos);
+
+            items.clear();
+            int field = 0;
+            for (size_t i = begin; i < end;) {
+                if (isspace((unsigned char)data[i]) || data[i] == ',') {
+                    ++i;
+                    continue;
+                }
+                size_t tokenEnd = i;
+                while (tokenEnd < end && !isspace((unsigned char)data[tokenEnd]) && data[tokenEnd] != ',') {
+                    ++tokenEnd;
+                }
+                bool negative = data[i] == '-';
+                size_t digits = i + negative;
+                long long value = 0;
+                bool valid = digits < tokenEnd;
+                for (size_t j = digits; j < tokenEnd && valid; ++j) {
+                    valid = data[j] >= '0' && data[j] <= '9' && value <= INT32_MAX;
+                    value = value * 10 + (data[j] - '0');
+                }
+                valid = valid && (negative ? -value >= INT32_MIN : value <= INT32_MAX);
+                i = tokenEnd;
+                if (!valid) {
+                    counters.skippedTokens++;
+                    continue;
+                }
+                if (field++ >= skipFields) items.push_back(negative ? -value : value);
+            }
+            if (field == 0) continue;
+
+            std::sort(items.begin(), items.end());
+            items.erase(std::unique(items.begin(), items.end()), items.end());
+            counters.transactions++;
+            passTransactions++;
+            return true;
+        }
+        if (passStart == 0) numTransactions = passTransactions;
+        passTransactions = 0;
+        endPass(true);
+        return false;
+    }
+
+    // Records a scan of transactions over the miner's in-memory copy
+    void noteMemoryScan(uint64_t transactions) { counters.memoryTransactions += transactions; }
+
+    // Closes a pass still in progress; it counts as partial
+    void finish() { endPass(false); }
+
+    const IoStats& stats() const { return counters; }
+};
+
+// Prints an I/O summary and appends a CSV row to $IO_REPORT if it is set.
+// levelWiseScans is the number of database scans plain level-wise Apriori
+// needs for the same result, one per itemset size.
+inline void reportIo(const std::string& algorithm, TxnSource& source, int levelWiseScans, double seconds) {
+    source.finish();
+    const IoStats& s = source.stats();
+    std::string dataset = source.name().substr(source.name().find_last_of('/') + 1);
+
+    std::cout << "I/O " << algorithm << " on " << dataset << ": " << s.fullPasses << " full + " << s.partialPasses
+              << " partial passes, " << s.transactions << " transactions read, " << s.bytesDisk << " bytes from disk, "
+              << s.bytesCache << " from cache, " << s.memoryTransactions << " rescanned in memory, " << seconds
+              << " s" << std::endl;
+    if (s.skippedTokens > 0) {
+        std::cerr << "Skipped " << s.skippedTokens << " tokens that are not integers" << std::endl;
+    }
+
+    const char* path = getenv("IO_REPORT");
+    if (!path || !*path) return;
+    bool fresh = std::ifstream(path).peek() == std::ifstream::traits_type::eof();
+    std::ofstream out(path, std::ios::app);
+    if (fresh) {
+        out << "algorithm,dataset,file_transactions,full_passes,partial_passes,transactions_read,bytes_disk,"
+               "bytes_cache,memory_transactions,level_wise_scans,seconds\n";
+    }
+    out << algorithm << ',' << dataset << ',' << source.size() << ',' << s.fullPasses << ',' << s.partialPasses << ','
+        << s.transactions << ',' << s.bytesDisk << ',' << s.bytesCache << ',' << s.memoryTransactions << ','
+        << levelWiseScans << ',' << seconds << '\n';
+}
+
+#endif